@@ -20,18 +20,21 @@
 // 0: depth, 1: flags, 2-3:value, 4-5:move, 6-7: nn,  8-15: lock, 
 // 				flags: (0: upper, 1: lower, 2: first entry, 3: from previous game, 4: from Helper,...)
 //
-// Pawn hash table: 40 bytes per entry
-// Byte 0-7:lock, 8-13: white pawn attacks, 14-15: opening value,
-// 16-17: endgame value, 18-23: black pawn attacks 
-// 24: flags (0:vertical- 1:horizontal opposition,..), 25-30: passers, 31: nn, 32:nn,
-// 33-38: weak pawns, 39: nn  
+// Pawn hash table: 64 bytes per bucket, 2 entries of 32 bytes (newest first)
+// Byte 0-7:lock (xor of key and bytes 8-31), 
+// 8: flags (0:vertical- 1:horizontal opposition,..), 9-14: passers, 15: nn,
+// 16: nn, 17-22: weak pawns, 23: nn, 24-25: opening value, 26-27: endgame value, 28-31: nn
 //
-// Material hash table: 8 bytes per entry
-// Byte 0-1:material value, 2-7:lock    
+// Material table: 4 bytes per entry, directly indexed by the material key
+// Byte 0-1:scaled material value, 2:scale factor, 3:recognizer available
+// key: P+9*N+27*B(dark)+54*B(light)+108*R+324*Q per side, black digits *648
 //
 // Evaluation hash table: 8 Bytes per entry
 // Byte 0-1:evaluation, 2-7:lock 
 //
+// Perft hash table: 64 Bytes per bucket, 4 entries of 16 Bytes
+// Byte 0-6:node count, 7:depth, 8-15:lock (hash xor data)
+//
 
 #include <ctype.h>
 #include <stdint.h>
@@ -43,10 +46,20 @@
 #include <pthread.h>
 #include <stdbool.h>
 #include <math.h>
+#include <sys/stat.h>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#else
+#include <malloc.h>
+#endif
 
 #define USE_AVX2   1
 //#define USE_NEON   1
 //#define USE_SSE2   0
+//#define USE_ATTACKS 1													// incrementally updated attack tables
+//#define CONST_PARAS 1													// evaluation and search parameters are compile-time constants
 
 #if 		defined(USE_AVX2)
 #include 	<immintrin.h>
@@ -56,11 +69,22 @@
 #include 	<emmintrin.h>
 #endif
 
+#if defined(_WIN32)
+#define ftell64		_ftelli64											// 64 bit file offsets (files > 4 GB)
+#define fseek64		_fseeki64
+#else
+#define ftell64		ftello
+#define fseek64		fseeko
+#endif
+
 #define max(x, y) (((x) > (y)) ? (x) : (y))
 #define min(x, y) (((x) < (y)) ? (x) : (y))
 
 #define MaxScore 	30256												// maximum material score
+#define MATN		419904												// number of material table entries (648 per side)
 #define PVN			0xFFFF												// size of PV table
+#define NOMOVES		255													// Mvs.cp of moves not yet generated
+#define TUNEMAGIC	0x31534D5441534345									// header of converted training records
 
 typedef unsigned char 		Byte;	
 typedef unsigned long long 	BitMap;
@@ -69,6 +93,12 @@ typedef unsigned short 		Dbyte;
 
 #include "Astimate.h"													// load constants
 
+typedef struct															// evaluation trace of the parameters
+{
+	float									O[128],E[128];				// coefficients of opening and endgame terms for white
+	float									V[128];						// coefficients of untapered terms for stm
+} Etrace;
+
 typedef struct															// game structure
 {
 	struct	{Byte type,index;} 				Piece[2][64];				// [color][square]
@@ -84,8 +114,13 @@ typedef struct															// game structure
 	Dbyte									Counter[2][17][64];			// counter move table
 	BitMap 									POSITION[2][7];				// positions of pieces [color][all, king, ..., pawns]
 	BitMap 									ROTATED[4];					// bitmaps of pieces [all, ]
+#if defined(USE_ATTACKS)
+	BitMap									ATKF[64];					// attacks from the piece on square (0: empty)
+#endif
 	BitMap  								PHASH;						// pawn hash
-	BitMap									MHASH;						// material hash
+	Fbyte									MKEY;						// material table index
+	Byte									Mexc;						// pieces beyond the material table range
+	Etrace*									Trace;						// coefficients of parameters of evaluation (NULL: off)
 	BitMap									NODES;						// node counter		
 	Dbyte									Currm;						// move currently calculated
 	Dbyte									Bestmove;					// Bestmove at root position
@@ -130,8 +165,39 @@ typedef struct
 	Byte									hist;						// number of history moves
 	Byte									cp;							// count pieces that can move
 	Dbyte									Bestmove;					// current Bestmove							
+	Dbyte									SeeM[8];					// SEE cache: moves
+	short									SeeV[8];					// SEE cache: exchange values
+	Byte									sn;							// SEE cache: number of moves
 } Mvs;
 
+typedef struct															// perft worker
+{
+	Game*									Gm;							// game copy of worker
+	BitMap volatile							R;							// task range: next (low 32 bits), end (high 32 bits)
+	BitMap									NODES;						// leafs counted
+	Fbyte									tasks,steals;				// tasks processed and stolen from other workers
+	Fbyte									n;							// worker number
+	pthread_t								Tid;						// thread ID
+} Pwork;
+
+typedef struct															// book builder node (arena allocated)
+{
+	BitMap									key;						// position hash (polyglot key)
+	Fbyte									cnt;						// frequency of move
+	Fbyte									next;						// next node in bucket chain
+	Dbyte									mov;						// move in polyglot format
+} Bnode;
+
+typedef struct															// book builder hash map of a parser thread
+{
+	Bnode*									Blk[0x10000];				// arena blocks of 0x10000 nodes
+	Fbyte*									Head;						// first node of bucket chains
+	Fbyte									N,Size;						// number of nodes, number of buckets
+	BitMap									Start,End;					// range of pgn file (64 bit offsets)
+	Fbyte									Games,Moves,Errors;			// games, moves and games with illegal moves
+	pthread_t								Tid;						// thread ID
+} Bmap;
+
 typedef struct
 {
 	Fbyte				F_ind[2][64] 	__attribute__((aligned(64)));	// NNUE feature indices white and black
@@ -139,6 +205,66 @@ typedef struct
 	int32_t				F_psq[2][8]		__attribute__((aligned(64)));	// NNUE piece square features white and black;
 } NNUE;
 
+typedef struct															// packed training position of gensfen (32 bytes)
+{
+	BitMap									Occ;						// occupied squares (bit 0: a8)
+	Byte									Pc[16];						// 4 bit codes of pieces in square order (1-6 white KQRBNP, 9-14 black)
+	Byte									Flags;						// color to move, castles (bits 1-4), result for stm+1 (bits 5-6)
+	Byte									Ep;							// ep square (0: none)
+	short									Score;						// search value for stm
+	Dbyte									Mov;						// best move
+	Dbyte									Ply;						// ply of game
+} Sfen;
+
+typedef struct															// linear evaluation coefficient of a parameter
+{
+	Byte									Par;						// index of parameter
+	short									Ref;						// parameter value of extraction
+	float									Op,Eg;						// eval change for stm per unit in opening and endgame
+} Ecoef;
+
+typedef struct															// material table entry
+{
+	short									Val;						// scaled material value for white
+	Byte									Scale;						// scale factor (64: no scaling)
+	Byte									Rec;						// recognizer for material signature available
+} Mat;
+
+typedef struct															// compare worker
+{
+	char									*Start,*End;				// range of csv file
+	short									limit;						// eval limit
+	Byte									v;							// print every position
+	int										n;							// number of compared positions
+	double									Diff;						// sum of eval differences
+	pthread_t								Tid;						// thread ID
+} Cwork;
+
+typedef struct															// coefficient of a training record
+{
+	Fbyte									i;							// index of record
+	Byte									k;							// index of tuned parameter
+	float									v;							// eval change per step of parameter
+} Tcoef;
+
+typedef struct															// tuner worker
+{
+	char									*Start,*End;				// range of csv file to convert
+	Sfen									*S;							// training records
+	Fbyte									n;							// number of records
+	float									*E;							// evaluations for stm
+	Byte									*K;							// tuned index of parameters (255: not tuned)
+	Tcoef									*C;							// coefficients of records
+	Fbyte									m;							// number of coefficients
+	pthread_t								Tid;						// thread ID
+} Twork;
+
+typedef struct															// arguments of search thread
+{
+	Game*									Gm;							// game of UCI thread
+	NNUE*									Nn;							// NNUE features of UCI thread
+} Sarg;
+
 struct Statistics {														// Statistics information
 	char	Name[20],Unit[5];											// name and unit of value
 	double 	Val;}														// value
@@ -154,7 +280,7 @@ struct Opt {															// Astimate's options
 	char	Name[20];													// name of option
 	bool 	Val,Change;}												// default value and change
 	
-Options[10] = {
+Options[11] = {
  	{"UCI",						true,	false},							// uci or terminal mode 	
 	{"UseOpeningTree", 			true,	false},							// use opening book tree
  	{"UseOpeningPoslib",		false,	false},							// use opening book positions
@@ -164,17 +290,18 @@ Options[10] = {
  	{"RecaptureExtension",		true,	false},							// extend recaptures
  	{"AdaptNull",				true, 	false},							// decrement null reduction when king is in danger
  	{"NNUEeval",				true,  	false},							// use NNUE evaluation instead of classic eval
- 	{"PrintStatistics",			false,	false}							// print search statistics
+ 	{"PrintStatistics",			false,	false},							// print search statistics
+ 	{"SimdAttacks",				false,	false}							// opponent slider attacks set-wise (avx2)
 };
 
 struct Par {															// Astimate's parameters
 	char	Name[30];													// name of the parameter
-	short	Val,Low,High,Change;}										// default, lower, upper value and change	
+	short	Val,Low,High,Change;};										// default, lower, upper value and change	
 
-Paras[107]	= {														
+constexpr struct Par CParas[109] = {									// default parameters
 	{"Hash",					128, 	1,  4096,  0},					// transposition table size (MB)
 	{"PawnTable",				 10, 	1,   100,  0},					// pawn hash table size (MB)
-	{"MaterialTable",			  1, 	1,     5,  0},					// material hash table size (MB)
+	{"MaterialTable",			  1, 	1,     5,  0},					// unused: material table is direct-indexed
 	{"EvaluationTable",			 10, 	1,   100,  0},					// evaluation hash table size (MB)
 	{"KingValue",			  10000,10000, 10000,  0},					// value of king opening	
 	{"QueenValueOpening",	   1980,    0,  3000, 10},					// value of queen opening 990, 2538
@@ -288,14 +415,37 @@ Paras[107]	= {
 	{"BishopValueEndgame",		650,    0,  1600, 10},					// value of bishop endgame, 915
 	{"KnightValueEndgame",		650,    0,  1600, 10},					// value of knight endgame,854
 	{"PawnValueEndgame",		200,    0,   600, 10},					// value of pawn endgame, 208
-	{"NNUEScaleFactor",			 24,	1,	 100,  0}					// divider for NNUE evaluations
+	{"NNUEScaleFactor",			 24,	1,	 100,  0},					// divider for NNUE evaluations
+	{"PerftSplitDepth",			  2,	1,	   8,  0},					// depth of perft tasks for work stealing
+	{"PerftHash",				 16,	1,	4096,  0}					// size of perft hash table in MB
 };
 
+struct Par	Paras[109];													// current parameters, copied from defaults
+
+#if defined(CONST_PARAS)												// evaluation and search use the defaults ...
+#define FIXED(i)	((i)>3&&((i)<90||(i)>93)&&((i)!=98)&&((i)<107))		// ... except for table sizes, time, threads, MultiPV, perft
+#define PAR(i)		(CParas[i].Val)
+constexpr short		SeeVal[8]	= {0,									// average piece values of opening and endgame
+	(CParas[4].Val+CParas[100].Val)/2,(CParas[5].Val+CParas[101].Val)/2,(CParas[6].Val+CParas[102].Val)/2,
+	(CParas[7].Val+CParas[103].Val)/2,(CParas[8].Val+CParas[104].Val)/2,(CParas[9].Val+CParas[105].Val)/2,0};
+#define PVAL(p)		(SeeVal[p])
+#define TRACE(a,i,k)	((void)0)										// parameters cannot be traced
+#else																	// all parameters can be changed by setoption
+#define FIXED(i)	false
+#define PAR(i)		(Paras[i].Val)
+#define PVAL(p)		((Paras[3+(p)].Val+Paras[99+(p)].Val)/2)
+#define TRACE(a,i,k)	(Gm->Trace?(void)(Gm->Trace->a[i]+=(k)):(void)0)	// add coefficient k of parameter i to term a
+#endif
+
 // Global variables
 
 short 			(*recog[1024])(Game*,Byte*);							// recognition function pointers
-Byte 			*hash_t,*phash_t,*mhash_t,*ehash_t;						// transposition-,pawn-,material and evaluation hash table
-BitMap	        HEN,PEN,MEN,EEN,DEN,HASHFILL,ALLNODES,MAXNODES;         // number of transposition table entries
+Byte 			*hash_t,*phash_t,*ehash_t,*perft_t;						// transposition-,pawn-,evaluation- and perft hash table
+BitMap	        HEN,PEN,EEN,DEN,HASHFILL,ALLNODES,MAXNODES;         	// number of transposition table entries
+Mat				*mat_t;													// direct-indexed material table
+Fbyte			MatW[2][7][2];											// material key weights [color][type][square color]
+constexpr Byte	MatCap[6]	= {1,2,1,1,2,8};							// table range of Q,R,B(light),B(dark),N,P counts
+BitMap			XRAY[64][64];											// squares behind second square seen from first (x-rays)
 BitMap	        TTACC,TTHIT1,TTHIT2,TTCUT,TTHLPR;						// table hits and cuts
 
 Dbyte	        				Movestogo,level,maxdepth,nmate;			// Number of moves to go												
@@ -308,7 +458,38 @@ volatile 		Byte			Stop,Ponder;
 volatile 		BitMap 			HISTORY[2][6][64][6][64];				// counter history table
 
 clock_t         StartTime;												// start time of calculation
+Dbyte			*PTask;													// perft tasks: root move index and move sequence
+BitMap			*PCnt;													// perft node count per task
+Fbyte			PTN,PTC,PWN;											// number of tasks, task list capacity, number of workers
+Byte			PTL,PDepth;												// split depth and remaining depth of perft tasks
+Pwork			*PW;													// perft workers
+Fbyte			PDone;													// perft completion counter
+pthread_mutex_t	PMutex=PTHREAD_MUTEX_INITIALIZER;						// mutex for perft completion counter
+pthread_cond_t	PCond=PTHREAD_COND_INITIALIZER;							// signals finished perft worker
 Dbyte			Line[]={0x0000};										// test line for debugging
+BitMap			*TreeIdx;												// tree book index: hash (bits 16-63) and move (bits 0-15)
+Fbyte			TreeN;													// number of tree book index entries
+Byte			*PolyBook;												// external polyglot book (mapped file)
+Fbyte			PolyN;													// number of polyglot book entries
+char			BookFile[256];											// file name of external polyglot book
+char			BBFile[256];											// pgn file of book builder
+char			*PosCmd;												// last position command
+Fbyte			PosCap;													// size of last position command buffer
+BitMap			PosHash;												// hash of position after last position command
+char			**CmdQ;													// input command queue (ring buffer)
+Fbyte			QH,QN,QCap;												// queue head, number of commands and capacity
+pthread_mutex_t	QMutex=PTHREAD_MUTEX_INITIALIZER;						// mutex for input queue, stop and ponder flags
+pthread_cond_t	QCond=PTHREAD_COND_INITIALIZER;							// signals new command, stop or ponderhit
+char			OBuf[0x10000];											// output ring buffer
+Fbyte			OHead,OTail;											// write and read counter of output ring buffer
+Fbyte			ODrop;													// info lines dropped when output buffer was full
+double			TCurr;													// wall time of last currmove output
+pthread_mutex_t	OMutex=PTHREAD_MUTEX_INITIALIZER;						// mutex for output ring buffer
+pthread_cond_t	OCond=PTHREAD_COND_INITIALIZER;							// signals new output or free space
+pthread_t		STid;													// search thread
+bool			Searching;												// search thread is running
+bool			Quiet;													// no search output (batch analysis)
+int				BBMaxply;												// maximum ply of book builder
 
 int32_t			NNUE_V;													// nnue network NNUE_V			(halfka: 0x7AF32F20)
 int16_t 		Biases		[512] 	 	__attribute__((aligned(64)));	// nnue transformer biases 		(halfka: 512)
@@ -322,25 +503,60 @@ int8_t			L2weights	[8192]		__attribute__((aligned(64)));	// layer stack level 2
 int8_t			L3weights	[256]		__attribute__((aligned(64)));	// layer stack level 3 weights 	(halfka: 8x32)
 
 void			SetGlobalDefaults();									// set global variables to initial defaults
+int				ParseArgs(int,char**);									// queue commands of command line
 void 			InitDataStructures();									// initialize basic data structures
 void 			InitNewGame(Game*);										// initialize a new game
 void 			ClearTables();											// clear all hashtables
+void			ClearEvalTables();										// clear pawn/evaluation hashtables, rebuild material table
+void			InitMaterial();											// fill direct-indexed material table
+void			MatEntry(Byte(*)[6],Byte,Mat*);							// material table entry of piece counts
+Byte			MatExcess(BitMap,Byte,Byte);							// piece exceeds material table range?
+void			SetHashSize(int);										// reallocate transposition table
+Byte			*AllocTable(int);										// allocate cache line aligned table
+void			FreeTable(Byte*);										// free aligned table
+void			Bench(Byte,Byte,int);									// search benchmark positions
+void			Analyze(char*,Byte,BitMap);								// analyze positions of epd file
+void			AnalyzeWorker(char**,Fbyte,Fbyte*,BitMap*,Byte,BitMap);	// analyze positions until file is done
+void			Gensfen(char*,BitMap,int);								// generate training positions by self play
+void			GensfenWorker(char*,BitMap,int,BitMap*,Byte);			// play games until enough positions are written
 void 			*ScanInput(void*);										// scan ascii input
+void			*SearchThread(void*);									// search thread started by "go"
+void			StopSearch();											// stop search and pondering
+void			WaitSearch();											// wait until running search has finished
+void			Output(const char*,bool);								// queue output for writer thread
+void			*WriteOutput(void*);									// writer thread for output ring buffer
+void			FlushOutput();											// wait until output buffer is written
+Byte			CommandCode(char*);										// command number of input line
+void			PushCommand(char*);										// append command to input queue
+char			*PopCommand();											// wait for next command of input queue
 double			Speed(Game*,Byte);										// speed test
 void 			ParseFen(Game*,char*);									// scans fen string and sets all variables
 void			GetPosition(Game*,char*);								// reads a psosition from input
+void			SetPosition(Game*,NNUE*,char*);							// position command, new moves only if possible
+void			PlayMoves(Game*,NNUE*,char*);							// makes moves of list and sets root moves
+char			*ReadLine(char**,Fbyte*);								// reads input line of any length
 bool 			TestCheck(Game*,Byte);									// test for check on square k
 bool 			TestMCheck(Game*,Mvs*,Dbyte);							// move may announce check?
 bool 			TestAttk(Game*,Byte,Byte,Byte);							// does piece attack higher piece on square?	
 void 			GenMoves(Game*, Mvs*);									// generate moves
+void			SliderAttacks(Game*,Byte,BitMap*,BitMap*);				// attacks of all sliders of a color at once
 Dbyte 			CodeMove(Game*,char*);									// get move as number
 void 			UncodeMove(Dbyte,char*);								// get move as string
 bool			TestLine(Game*,Byte);									// test sequence of moves
 void 			Move(Game*,Dbyte);										// make a move
 void 			UnMove(Game*);											// take back move
+BitMap			PieceAttacks(Game*,Byte,Byte,Byte);						// attacks of piece type/color from square
+void			InitAttacks(Game*);										// compute attack tables from scratch
+void			UpdateAttacks(Game*,BitMap);							// update attack tables along changed squares
+BitMap			AttacksTo(Game*,Byte,Byte);								// pieces of color attacking square
 Dbyte 			PickMove(Game*,Mvs*);									// pick moves from movelist
 void 			Perft(Game*,Byte);										// get Perft(d) of position				
 void 			*PerftCount(void*);										// recursive node counting
+BitMap			PerftParallel(Game*,Byte,Dbyte*,BitMap*,Byte);			// task based perft with work stealing
+void			PerftSuite(char*,Byte);									// verify perft counts of epd file
+void			PerftTasks(Game*,Byte,Dbyte*);							// collect perft tasks down to split depth
+void			*PerftWorker(void*);									// perft worker thread
+double			WallTime();												// wall clock time in seconds
 void 			Divide(Game*,Byte);										// print divide of position
 void 			StoreHashP(Game*,BitMap);								// store entry in perft table
 BitMap 			GetHashP(Game*);										// get entry from perft table
@@ -348,9 +564,26 @@ BitMap 			GetHash(Game*);											// get entry from transposition table
 void			StoreHash(Game*,short,Dbyte,Byte,Byte);					// store transposition information
 void 			PrintBM(BitMap);										// print bitmap
 short			Popcount(BitMap);										// count set bits in bitmap
+BitMap			Spawn(BitMap,Byte);										// file spans of pawns (0: to rank 8, 1: to rank 1)
+BitMap			SpawnStop(BitMap,BitMap,Byte);							// file spans stopping behind first occupied square
+BitMap			Sides(BitMap);											// squares with a neighbour in bitmap
+BitMap			BothSides(BitMap);										// squares with neighbours on both sides in bitmap
 Dbyte			Book(Game*);											// check opening books
+void			InitBook();												// build index of tree book
+Fbyte			BookFind(const BitMap*,Fbyte,BitMap,Byte,Fbyte*);		// binary search of position in sorted book
+int				CompareKey(const void*,const void*);					// compare function for sorting book keys
+void			OpenBook(char*);										// map external polyglot book
+Dbyte			PolyProbe(Game*);										// weighted move from external polyglot book
+Dbyte			PolyMove(Game*,Dbyte);									// translate polyglot move, 0 if illegal
+Dbyte			PolyCode(Game*,Dbyte);									// translate move to polyglot format
+Dbyte			SanMove(Game*,char*);									// translate SAN move, 0 if illegal
+void			BuildBook(char*,char*,int,int);							// build book from pgn file
+void			*BookWorker(void*);										// pgn parser thread of book builder
+void			BookAdd(Bmap*,BitMap,Dbyte,Fbyte);						// count move of position in book map
+int				CompareBnode(const void*,const void*);					// compare function for sorting book nodes
 bool 			DrawTest(Game*);										// position is draw?	
-bool 			SEE(Game*,Dbyte,short);									// SEE of current move larger than threshold
+bool 			SEE(Game*,Mvs*,Dbyte,short);							// SEE of current move larger than threshold
+short			SeeValue(Game*,Dbyte);									// static exchange value of move (swap list)
 void			PrintMoves(Game*);										// print all legal moves
 void			PrintPosition(Game*,NNUE*);								// print board
 short 			MatEval(Game*);											// material evaluation
@@ -368,9 +601,27 @@ void 			GetPV(Game*);											// retrieve principal variation
 void 			PrintPV(Game*,short,short,short);						// print PV
 void			PrintStats();											// print search statistics
 void 			PrintCurrent(Game*,Dbyte,Dbyte);						// prints current move
-double			CompareEval(char*,short,int);							// compares static evaluation with eval in csv dataset
-void			ParseParameters(char*,int);								// test possible parameter changes
+double			CompareEval(char*,short,int,Byte);						// compares static evaluation with eval in csv dataset
+void			*CompareWorker(void*);									// compares evaluations of a range of the csv file
+char			*MapFile(char*,BitMap*);								// map file read only into memory
+void			UnmapFile(char*,BitMap);								// release mapped file
+void			SplitLines(char*,char*,int,char**);						// split range of file at line ends
+bool			CsvLine(char*,char*,char*,int*);						// fen and evaluation of csv line
+void			PackSfen(Game*,Sfen*);									// pack position into training record
+void			UnpackSfen(Sfen*,char*);								// fen string of training record
+#if !defined(CONST_PARAS)												// tuner only for changeable parameters
+bool			QuietLeaf(Game*,NNUE*);									// play quiescence search PV to its leaf
+void			*ConvertWorker(void*);									// convert a range of the csv file to quiet records
+void			*TuneWorker(void*);										// evaluate a range of training records
+void			TuneEvals(Sfen*,Fbyte,float*);							// evaluate all training records
+void			TuneCoefs(Sfen*,Fbyte,Byte*,Byte,Fbyte**,float**,Fbyte*);// linear coefficients of all training records
+double			TuneLoss(Sfen*,Fbyte,float*);							// mean squared error of winning probabilities
+void			Tune(char*,Fbyte,int);									// texel tuning of evaluation parameters
+#endif
 void			DebugEval(Game*);										// debug evaluation parameters
+#if !defined(CONST_PARAS)
+Byte			EvalCoefficients(Game*,Mvs*,Ecoef*,short*);				// linear coefficients of evaluation parameters
+#endif
 bool			NNUE_InitNetwork(FILE*);								// initialize NNUE evaluation function network
 void			NNUE_InitFeatures(Game*,NNUE*,Byte);					// initialize NNUE feature vector
 void			NNUE_UpdateFeatures(Game*,NNUE*);						// update NNUE features after move
@@ -430,24 +681,38 @@ short 			KRvKRP(Game*,Byte*);
 
 void			PrintVector(void*,Byte);
 
-int 	main()
+int 	main(int argc, char* argv[])
 {
  Game		Gm;
  Mvs		Mv;
  NNUE		Nn;
+ Sarg		Sa;															// arguments of search thread
  Byte		i,j,d;
  Dbyte		Mov;
- char 		Com[50],Pos[100],*Is;
- int		Iv,n,m;
+ char 		Com[50],Pos[100],Pgn[256],*Is;
+ int		Iv,n,m,Need;
  clock_t 	t1;
  BitMap		BM;
  double		sp,eff;
  FILE		*fp;
  
- struct 	Inp {char Str[5000]; Byte volatile inp;} Input={" ",0};		// structure for user/GUI input  
- pthread_t	Tid0; 														// thread ID for user input
- pthread_create(&Tid0, NULL, ScanInput, (void*)(&Input));				// create the thread for ascii input	   
+ struct 	Inp {char* Str; Byte inp;} Input={NULL,0};						// current command of user/GUI input  
+ pthread_t	Tid0,Tid1; 													// thread IDs for user input and output
+ memcpy(Paras,CParas,sizeof(Paras));									// default parameters
+ if((Need=ParseArgs(argc,argv))<0)										// needs: 1 tables, 2 NNUE, 4 books, 8 input
+ {
+  printf("usage: Astimate3 [--hash MB] [--threads n] [--depth d] [command]\n");
+  printf("commands: perft [fen|startpos] depth, divide [fen|startpos] depth, perftsuite file [maxdepth],\n");
+  printf("          bench [depth] [threads] [hashMB], compare file min max, optimize file [n] [it],\n");
+  printf("          buildbook pgn book [maxply] [minfreq], analyze file [depth d|nodes n|movetime ms],\n");
+  printf("          gensfen file [positions] [nodes]\n");
+  return(1);
+ }
+ if(Need&8) pthread_create(&Tid0, NULL, ScanInput, NULL);				// create the thread for ascii input	   
+ pthread_create(&Tid1, NULL, WriteOutput, NULL);						// create the thread for output
  InitDataStructures();	InitNewGame(&Gm);								// initialize global data
+ if(Need&4) InitBook();	else Options[1].Val=Options[2].Val=false;		// index tree book only for games
+ if(!(Need&2)) Options[8].Val=false;									// NNUE only for evaluation
  GetPosition(&Gm,Startpos); strcpy(Pos,Startpos);						// default is startpos
  SetGlobalDefaults();													// set global variables to default values
  if(Options[8].Val)														// NNUE enabled?
@@ -462,33 +727,38 @@ int 	main()
  
  while(1)
  {
-  while(!Input.inp) usleep(1000);	    								// sleep 1/1000s to prevent busy thread
+  free(Input.Str); Input.Str=PopCommand();								// sleep until next command arrives
+  Input.inp=CommandCode(Input.Str);										// command number
+  if((Input.inp>1)&&(Input.inp!=9)&&(Input.inp!=10)) WaitSearch();		// other commands wait for end of search
   //if(Input.inp>49) Options[0].Val=0;                                   // terminal mode (no UCI) recognized
   switch(Input.inp)														// main program loop
   {
    case 0:  break;
-   case 1:	printf("readyok\n"); fflush(stdout); Input.inp=0; 	break;	// default answer to ping "isready"																		
-   case 2:  free(hash_t); free(phash_t); free(mhash_t); free(ehash_t);	// free hash table space
+   case 1:	Output("readyok\n",true);		Input.inp=0; 		break;	// answer "isready" at once, also while searching																		
+   case 2:  free(hash_t); FreeTable(phash_t); free(mat_t);				// free hash table space
+   			FreeTable(ehash_t);
+   			FreeTable(perft_t); FlushOutput();
    			return(0); 													// "quit" command from GUI
-   case 3:  strncpy(Pos,Input.Str+13,100);
-   			GetPosition(&Gm,Input.Str);	
-			if(Options[8].Val) NNUE_InitFeatures(&Gm,&Nn,3);            // init NNUE features
+   case 3:  if((Is=strstr(Input.Str,"fen "))) {strncpy(Pos,Is+4,99); Pos[99]=0;}
+   			else strcpy(Pos,Startpos);									// initial position for take back
+   			SetPosition(&Gm,&Nn,Input.Str);								// new position or new moves only
 			                            Input.inp=0;			break;	// get position and moves
    case 4:	printf("id name Astimate3\n");								// answer to "uci" request from GUI
 		    printf("id author Dr. Axel Steinhage, Germany, 2021\n"); 	// engine and author name 
 		    printf("option name ClearTT type button\n");				// Clear hash table button
+		    printf("option name BookFile type string default <empty>\n");// external polyglot book
 		    for(i=1;i<sizeof(Options)/sizeof(Options[0]);i++)			// announce engine options
 		     if(Options[i].Val)
 			 	printf("option name %s type check default true\n",
 				 									Options[i].Name);
 			 else printf("option name %s type check default false\n",
 			 										Options[i].Name);
-		    for(i=0;i<sizeof(Paras)/sizeof(Paras[0]);i++)				// announce engine parameters
+		    for(i=0;i<sizeof(Paras)/sizeof(Paras[0]);i++) if(!FIXED(i))// announce engine parameters
 		     printf("option name %s type spin default %d min %d max %d\n",
 			  Paras[i].Name,Paras[i].Val,Paras[i].Low,Paras[i].High);
 			printf("uciok\n"); 											// this is an UCI engine
 		    fflush(stdout); 				Input.inp=0;		break;
-   case 5:	maxdepth=level=nmate=0; MAXNODES=0;	Input.inp=0;			// "go" command from GUI
+   case 5:	maxdepth=level=nmate=0; MAXNODES=0;							// "go" command from GUI
 			Wtime=Btime=Winc=Binc=Movetime=0; Movestogo=0;				// initialize values
 			if((Is=strstr(Input.Str,"searchmoves")))					// search only selected moves?
 			{
@@ -522,61 +792,48 @@ int 	main()
 		    if((Is=strstr(Input.Str,"movetime"))) 						// exact time per move
 			 		{level=6; sscanf(Is,"%s %ld",Com,&Movetime);}
 		    if((Is=strstr(Input.Str,"infinite"))) level=1;				// infinite
-		    if(nmate) FindMate(&Gm); else IterateSearch(&Gm);			// start search
-		    while(Ponder); 												// do not return while in ponder mode
-		    UncodeMove(Gm.Move2Make,Com);								// get best move
-		    if(!(Options[0].Val))                                       // terminal mode
-		    {
-		     if((Mov=CodeMove(&Gm,Com)))							    // make move
-   			 {
-			  Move(&Gm,Mov); 
-			  if(Options[8].Val) NNUE_UpdateFeatures(&Gm,&Nn);			// move and update NNUE features 
-			  Gm.Move_r=Gm.Move_n;										// set root move number
-              GenMoves(&Gm,&Mv);										// generate moves
-              Mv.o=Mv.flg=i=0; Mv.s=200; 								// init move picker
-              while((Gm.Root[i]).Mov=PickMove(&Gm,&Mv)) 
-               {(Gm.Root[i]).Order=1; (Gm.Root[i]).flags=0; i++;}	    // fill root move list	
-			  PrintPosition(&Gm,&Nn);  									// show new position
-			 }						
-   		     else printf("illegal move!\n");	Input.inp=0; 	break;	// wrong move
-   		    }	
-		    printf("bestmove %s ",Com); 
-		    if(Gm.Pmove) 												// ponder move exists
-			 {UncodeMove(Gm.Pmove,Com); printf("ponder %-7s",Com);}		// get ponder move
-			printf("\n"); fflush(stdout);					
-			for(BM=0;BM<2*HEN;BM++) hash_t[16*BM+1]|=0x08;		break;	// set age flag 
+		    Input.inp=0; Stop=false; Searching=true;					// input parsed, start search thread
+		    Sa.Gm=&Gm; Sa.Nn=&Nn; pthread_create(&STid,NULL,SearchThread,(void*)(&Sa));	break;
    case 7:	InitNewGame(&Gm); 				Input.inp=0; 		break;	// prepare new game
+   case 9:	StopSearch();					Input.inp=0; 		break;	// stop calculating
+   case 10:	pthread_mutex_lock(&QMutex); Ponder=false;					// ponder move made
+   			pthread_cond_broadcast(&QCond); pthread_mutex_unlock(&QMutex);
+   											Input.inp=0; 		break;
    case 8:	if(strstr(Input.Str,"ClearTT")) 							// clear hash tables
    							{ClearTables();	Input.inp=0;		break;}
+   			if(strstr(Input.Str,"BookFile"))							// external book
+   			{
+   			 if((Is=strstr(Input.Str," value "))) Is+=7; else Is=(char*)"";
+   			 strncpy(BookFile,Is,255); BookFile[strcspn(BookFile,"\r\n")]=0;// file name is rest of line
+   			 OpenBook(BookFile); 					Input.inp=0;		break;
+   			}
    			for(i=1;i<sizeof(Options)/sizeof(Options[0]);i++)			// scan options
    			 if(Is=strstr(Input.Str,Options[i].Name))					// option found
    			  if(strstr(Input.Str,"true")) 	Options[i].Val=true;
    			  else 							Options[i].Val=false;
 			for(i=0;i<sizeof(Paras)/sizeof(Paras[0]);i++)				// scan parameters
-   			 if(Is=strstr(Input.Str,Paras[i].Name))						// parameter found
+   			 if((!FIXED(i))&&(Is=strstr(Input.Str,Paras[i].Name)))		// parameter found
    			  if(sscanf(Is,"%s %s %d",Com,Com,&Iv)==3)					// "setoption Name value Iv"
 			  	if((Iv>=Paras[i].Low)&&(Iv<=Paras[i].High))				// value is in the allowed range
 				{
 				 Paras[i].Val=Iv; switch(i)								// set value and handle special cases
 				 {
-				  case 0: free(hash_t);									// change TT size, free memory 
-				  		  HEN=(BitMap)(Iv*0x100000)/32;					// number of TT entries
-				  		  DEN=(BitMap)(Iv*0x100000)/16; 				// number of perft/divide table entries
-				  		  hash_t=(Byte*)(malloc(Iv*0x100000+32));		// allocate memory for transposition table
-						  break;
-				  case 1: free(phash_t);								// change pawn hashtable size, free memory 
-				  		  PEN=(BitMap)(Iv*0x100000)/40;					// number of pawn hasth table entries
-				  		  phash_t=(Byte*)(malloc(Iv*0x100000+40));		// allocate memory for pawn hash table
-				  		  break;
-				  case 2: free(mhash_t);								// change material hashtable size, free memory 
-				  		  MEN=(BitMap)(Iv*0x100000)/8;					// number of material hash table entries
-				  		  mhash_t=(Byte*)(malloc(Iv*0x100000+8));		// allocate memory for material hash table
+				  case 0: SetHashSize(Iv);						break;	// change TT size
+				  case 1: FreeTable(phash_t);							// change pawn hashtable size, free memory 
+				  		  PEN=(BitMap)(Iv*0x100000)/64;					// number of pawn hash table buckets
+				  		  phash_t=AllocTable(Iv);						// allocate memory for pawn hash table
 				  		  break;
-				  case 3: free(ehash_t);								// change evaluation hashtable size, free memory 
+				  case 3: FreeTable(ehash_t);							// change evaluation hashtable size, free memory 
 				  		  EEN=(BitMap)(Iv*0x100000)/8;					// number of evaluation hash table entries
-				  		  ehash_t=(Byte*)(malloc(Iv*0x100000+8));		// allocate memory for evaluation hash table
+				  		  ehash_t=AllocTable(Iv);						// allocate memory for evaluation hash table
+				  		  break;
+				  case 108: FreeTable(perft_t);							// change perft hashtable size, free memory
+				  		  DEN=(BitMap)(Iv*0x100000)/64;					// number of perft table buckets
+				  		  perft_t=AllocTable(Iv);						// allocate memory for perft hash table
+				  		  break;
+				  default: if(((i>4)&&(i<11))||((i>100)&&(i<106)))		// material parameter
+				  		    InitMaterial();								// rebuild material table
 				  		  break;
-				  default: break;
 				 }
 				}
    											Input.inp=0; 		break;
@@ -587,9 +844,14 @@ int 	main()
    case 52: PrintMoves(&Gm);				Input.inp=0;		break;	// print all legal moves
    case 53: PrintPosition(&Gm,&Nn); 	 	Input.inp=0; 		break;	// print board
    case 54: sscanf(Input.Str,"%s %s %d %d",Com,Com,&m,&n); Input.inp=0;	// get csv filename and eval limit
-			CompareEval(Com,m,n);								break;	// get eval difference
-   case 55: sscanf(Input.Str,"%s %s %d",Com,Com,&n); Input.inp=0;		// get csv filename and eval limit
-			ParseParameters(Com,n);								break;	// parse parameters for optimization			
+			CompareEval(Com,m,n,strstr(Input.Str,"verbose")!=NULL);	break;	// get eval difference
+   case 55: m=5; n=0; sscanf(Input.Str,"%s %s %d %d",Com,Com,&n,&m);	// get file, positions and iterations
+   			Input.inp=0;
+#if defined(CONST_PARAS)
+			printf("Parameters are compile-time constants in this build!\n"); break;
+#else
+			Tune(Com,n,m);										break;	// tune evaluation parameters
+#endif
    case 56: if((Mov=CodeMove(&Gm,Input.Str)))							// make move
    			{
 			 Move(&Gm,Mov); 
@@ -621,49 +883,255 @@ int 	main()
 		    }
 			printf("I suggest %d helper threads\n",j-1);				// take one less for GUI etc
 												Input.inp=0; 	break;  			
+   case 59: n=255; sscanf(Input.Str,"%s %s %d",Com,Com,&n); Input.inp=0;// get epd filename and max depth
+   			PerftSuite(Com,min(n,255));									break;	// verify perft counts
+   case 60: d=8; i=1; n=16; Input.inp=0;									// default depth, threads and hash size
+   			sscanf(Input.Str,"%s %hhu %hhu %d",Com,&d,&i,&n);			// get parameters
+   			Bench(max(d,1),max(i,1),max(min(n,Paras[0].High),1));	break;	// search benchmark
+   case 61: m=40; n=2; Pgn[0]=Com[0]=0; Input.inp=0;					// default max. ply and min. frequency
+   			sscanf(Input.Str,"%s %255s %49s %d %d",Pgn,Pgn,Com,&m,&n);	// get pgn and book filename, parameters
+   			if(Com[0]) BuildBook(Pgn,Com,max(m,1),max(n,1));			// build book
+   			break;
+   case 62: d=3; BM=10; Pgn[0]=0; Input.inp=0;							// default: depth 10
+   			sscanf(Input.Str,"%s %255s",Pgn,Pgn);						// get epd filename
+   			if((Is=strstr(Input.Str," nodes "))) 		d=4;			// node limit
+   			else if((Is=strstr(Input.Str," movetime "))) d=6;			// time limit in ms
+   			else Is=strstr(Input.Str," depth ");						// depth limit
+   			if(Is) sscanf(Is,"%s %llu",Com,&BM);
+   			Analyze(Pgn,d,max(BM,1));							break;	// analyze positions
+   case 63: BM=100000; n=5000; Pgn[0]=0; Input.inp=0;					// default positions and nodes per move
+   			sscanf(Input.Str,"%s %255s %llu %d",Pgn,Pgn,&BM,&n);		// get output filename and parameters
+   			if(Pgn[0]) Gensfen(Pgn,max(BM,1),max(n,1));					// self play training data
+   			break;
   }
  }
  return(0);																// exit program
 }
 
+void	*SearchThread(void *Pe)											// search thread started by "go"
+{
+ Game	*Gm=((Sarg*)(Pe))->Gm;
+ NNUE	*Nn=((Sarg*)(Pe))->Nn;
+ Mvs	Mv;
+ BitMap	BM;
+ Dbyte	Mov;
+ char	Com[10],Ln[40];
+ int	i;
+
+ if(nmate) FindMate(Gm); else IterateSearch(Gm);						// start search
+ pthread_mutex_lock(&QMutex);											// do not return while in ponder mode
+ while(Ponder) pthread_cond_wait(&QCond,&QMutex);						// sleep until ponderhit or stop
+ pthread_mutex_unlock(&QMutex);
+ UncodeMove(Gm->Move2Make,Com);											// get best move
+ if(!(Options[0].Val))                                       			// terminal mode
+ {
+  FlushOutput();														// search output before position
+  if((Mov=CodeMove(Gm,Com)))							    			// make move
+  {
+   Move(Gm,Mov); 
+   if(Options[8].Val) NNUE_UpdateFeatures(Gm,Nn);						// move and update NNUE features 
+   Gm->Move_r=Gm->Move_n;												// set root move number
+   GenMoves(Gm,&Mv);													// generate moves
+   Mv.o=Mv.flg=i=0; Mv.s=200; 											// init move picker
+   while((Gm->Root[i]).Mov=PickMove(Gm,&Mv)) 
+    {(Gm->Root[i]).Order=1; (Gm->Root[i]).flags=0; i++;}	    		// fill root move list	
+   PrintPosition(Gm,Nn);  												// show new position
+  }						
+  else {printf("illegal move!\n");							return NULL;}	// wrong move
+ }	
+ sprintf(Ln,"bestmove %s ",Com); 
+ if(Gm->Pmove) 															// ponder move exists
+  {UncodeMove(Gm->Pmove,Com); sprintf(Ln+strlen(Ln),"ponder %-7s",Com);}// get ponder move
+ strcat(Ln,"\n"); Output(Ln,true);
+ for(BM=0;BM<2*HEN;BM++) hash_t[16*BM+1]|=0x08;							// set age flag 
+ return NULL;
+}
+
+void	StopSearch()													// stop search and pondering
+{
+ pthread_mutex_lock(&QMutex);
+ Stop=true; Ponder=false;												// stop calculating
+ pthread_cond_broadcast(&QCond); pthread_mutex_unlock(&QMutex);			// wake up search thread waiting for ponderhit
+}
+
+void	WaitSearch()													// wait until running search has finished
+{
+ if(Searching) {pthread_join(STid,NULL); Searching=false;}
+ FlushOutput();															// search output before next answers
+}
+
+void	Output(const char* Str, bool Must)								// queue output for writer thread
+{
+ Fbyte	n=strlen(Str),T,m;
+ 
+ pthread_mutex_lock(&OMutex);
+ while(OHead-OTail+n>sizeof(OBuf))										// not enough space in ring buffer
+ {
+  if(!Must) {ODrop++; pthread_mutex_unlock(&OMutex); return;}			// drop info line, never stall search
+  pthread_cond_wait(&OCond,&OMutex);									// wait for writer thread
+ }
+ T=OHead&(sizeof(OBuf)-1); m=min(n,sizeof(OBuf)-T);						// copy in up to two parts
+ memcpy(OBuf+T,Str,m); memcpy(OBuf,Str+m,n-m); OHead+=n;
+ pthread_cond_broadcast(&OCond); pthread_mutex_unlock(&OMutex);			// wake up writer thread
+}
+
+void	*WriteOutput(void *Pe)											// writer thread for output ring buffer
+{
+ Fbyte	T,n;
+ 
+ pthread_mutex_lock(&OMutex);
+ while(1)
+ {
+  while(OHead==OTail) pthread_cond_wait(&OCond,&OMutex);				// sleep until output arrives
+  T=OTail&(sizeof(OBuf)-1); n=min(OHead-OTail,sizeof(OBuf)-T);			// contiguous part of buffer
+  pthread_mutex_unlock(&OMutex);
+  fwrite(OBuf+T,1,n,stdout); fflush(stdout);							// write without holding the lock
+  pthread_mutex_lock(&OMutex);
+  OTail+=n; pthread_cond_broadcast(&OCond);								// free space, wake up waiting threads
+ }
+ return NULL;
+}
+
+void	FlushOutput()													// wait until output buffer is written
+{
+ pthread_mutex_lock(&OMutex);
+ while(OHead!=OTail) pthread_cond_wait(&OCond,&OMutex);
+ pthread_mutex_unlock(&OMutex);
+}
+
 void 	*ScanInput(void *Pe)											// scan user/GUI input
 {
- struct In {char Str[5000]; volatile Byte inp;} *Input;					// structure for user input
- char*   c;
+ char*   L;
+ Fbyte	 Cap=5000;
  
- Input=(struct In*)Pe;													// cast input pointer					 
+ L=(char*)malloc(Cap);													// input line, enlarged for long games
  	
  //setbuf(stdout, NULL); setbuf(stdin, NULL);
  
- while(1) 
+ while(1) 																// blocking read of next line
  {
-  usleep(1000);															// sleep 1/10000s to prevent busy thread
-  if(!(Input->inp))														// endless loop over input
+  if(!ReadLine(&L,&Cap)) strcpy(L,"quit\n");							// end of input: leave program
+  if(!strncmp(L,"quit",4)) StopSearch();								// quit ends running search at once
+  PushCommand(strdup(L));												// queue command
+  if(!strncmp(L,"quit",4)) break;
+ }
+ free(L);
+ return NULL;
+}
+
+Byte	CommandCode(char* Str)											// get command number of input line
+{
+ Byte	c=0;
+
+ if(!strncmp(Str,"isready",7))				c=1;						// ping
+ if(!strncmp(Str,"quit",4))					c=2;						// leave program
+ if(!strncmp(Str,"position",8))				c=3;						// position and moves input
+ if(!strncmp(Str,"ucinewgame",10))			c=7;						// new game
+ else if(!strncmp(Str,"uci",3))				c=4;						// uci compatible?
+ if(!strncmp(Str,"go",2))					c=5;						// start calculating
+ if(!strncmp(Str,"stop",4))					c=9;						// stop calculating
+ if(!strncmp(Str,"ponderhit",9))			c=10;						// ponder move made
+ if(!strncmp(Str,"setoption",9))			c=8;						// configure options
+ if(!strncmp(Str,"perftsuite",10))			c=59;						// perft suite
+ else if(!strncmp(Str,"perft",5))			c=50;						// perft
+ if(!strncmp(Str,"divide",6))				c=51;						// divided perft
+ if(!strncmp(Str,"list",4))					c=52;						// list moves
+ if(!strncmp(Str,"show",4))					c=53;						// print board
+ if(!strncmp(Str,"compare",7))				c=54;						// compare static eval with eval in csv dataset
+ if(!strncmp(Str,"optimize",7))				c=55;						// check evaluation parameters for optimization
+ if(isalpha(Str[0]) && isdigit(Str[1]) &&
+    isalpha(Str[2]) && isdigit(Str[3]))		c=56;						// move
+ if(!strncmp(Str,"back",4))					c=57;						// take back move
+ if(!strncmp(Str,"speed",5))				c=58;						// speedtest
+ if(!strncmp(Str,"bench",5))				c=60;						// search benchmark
+ if(!strncmp(Str,"buildbook",9))			c=61;						// build opening book from pgn
+ if(!strncmp(Str,"analyze",7))				c=62;						// batch analysis of epd file
+ if(!strncmp(Str,"gensfen",7))				c=63;						// generate training data by self play
+ return c;
+}
+
+void	PushCommand(char* Str)											// append command to input queue
+{
+ Fbyte	i;
+ char	**Q;
+
+ pthread_mutex_lock(&QMutex);
+ if(QN==QCap)															// queue full: double capacity
+ {
+  Q=(char**)malloc(2*(QCap+1)*sizeof(char*));
+  for(i=0;i<QN;i++) Q[i]=CmdQ[(QH+i)%QCap];
+  free(CmdQ); CmdQ=Q; QCap=2*(QCap+1); QH=0;
+ }
+ CmdQ[(QH+QN)%QCap]=Str; QN++;											// store command
+ pthread_cond_broadcast(&QCond); pthread_mutex_unlock(&QMutex);			// wake up waiting main thread
+}
+
+char	*PopCommand()													// wait for next command of input queue
+{
+ char	*Str;
+
+ pthread_mutex_lock(&QMutex);
+ while(!QN) pthread_cond_wait(&QCond,&QMutex);							// sleep until command arrives
+ Str=CmdQ[QH]; QH=(QH+1)%QCap; QN--;
+ pthread_mutex_unlock(&QMutex);
+ return Str;
+}
+
+int		ParseArgs(int argc, char* argv[])								// queue commands of command line
+{
+ char	Cmd[1000],*P[8];
+ int	i,n=0,hash=0,threads=0,depth=0,Need=3;
+
+ if(argc<2) return 15;												// interactive: tables, NNUE, books and input
+ for(i=1;i<argc;i++)
+  if(!strncmp(argv[i],"--",2))											// option with value
+  {
+   if(i+1==argc) 						return -1;
+   if(!strcmp(argv[i],"--hash")) 		hash=atoi(argv[++i]);			// hash size in MB
+   else if(!strcmp(argv[i],"--threads")) threads=atoi(argv[++i]);		// number of threads
+   else if(!strcmp(argv[i],"--depth")) 	depth=atoi(argv[++i]);			// search depth
+   else 								return -1;
+  }
+  else if(n<8) P[n++]=argv[i];											// subcommand and arguments
+ if(!n) 								return -1;
+ if(threads>0) Paras[93].Val=min(threads-1,Paras[93].High);			// helper threads
+ if(!strcmp(P[0],"perft")||!strcmp(P[0],"divide"))						// perft [fen|startpos] depth
+ {
+  if(n>2) 																// position given
   {
-   c=fgets(Input->Str,4999,stdin);  		    Input->inp = 0;			// read standard input
-   if(!strncmp(Input->Str,"isready",7)) 		Input->inp = 1;			// ping
-   if(!strncmp(Input->Str,"quit",4)) 	  		Input->inp = 2;			// leave program
-   if(!strncmp(Input->Str,"position",8)) 		Input->inp = 3;			// position and moves input
-   if(!strncmp(Input->Str,"ucinewgame",10)) 	Input->inp = 7;			// new game
-   else if(!strncmp(Input->Str,"uci",3)) 		Input->inp = 4;			// uci compatible?
-   if(!strncmp(Input->Str,"go",2))  	   		Input->inp = 5;			// start calculating
-   if(!strncmp(Input->Str,"stop",4)) 	  	{Stop=true;	Ponder=false;}	// stop calculating
-   if(!strncmp(Input->Str,"ponderhit",9))		Ponder=false; 			// ponder move made
-   if(!strncmp(Input->Str,"setoption",9))		Input->inp = 8;			// configure options
-   if(!strncmp(Input->Str,"perft",5))   		Input->inp = 50;		// perft		
-   if(!strncmp(Input->Str,"divide",6))  		Input->inp = 51;		// divided perft
-   if(!strncmp(Input->Str,"list",4))  			Input->inp = 52;		// list moves
-   if(!strncmp(Input->Str,"show",4))	 		Input->inp = 53;		// print board
-   if(!strncmp(Input->Str,"compare",7))			Input->inp = 54;		// compare static eval with eval in csv dataset
-   if(!strncmp(Input->Str,"optimize",7))		Input->inp = 55;		// check evaluation parameters for optimization
-   if(isalpha(Input->Str[0]) && isdigit(Input->Str[1]) &&
-      isalpha(Input->Str[2]) && isdigit(Input->Str[3]))
-     							 				Input->inp = 56;		// move
-   if(!strncmp(Input->Str,"back",4))   			Input->inp = 57;		// take back move
-   if(!strncmp(Input->Str,"speed",5))   		Input->inp = 58;		// speedtest
+   if(!strcmp(P[1],"startpos")) strcpy(Cmd,"position startpos\n");
+   else snprintf(Cmd,sizeof(Cmd),"position fen %s\n",P[1]);
+   PushCommand(strdup(Cmd));
   }
+  if(!depth) depth=(n>1)?atoi(P[n-1]):5;
+  sprintf(Cmd,"%s %d\n",P[0],max(depth,1));
  }
- return NULL;
+ else if(!strcmp(P[0],"bench"))											// bench [depth] [threads] [hashMB]
+ {
+  if(!depth) 	depth=(n>1)?atoi(P[1]):8;
+  if(!threads) 	threads=(n>2)?atoi(P[2]):1;
+  if(!hash) 	hash=(n>3)?atoi(P[3]):16;
+  hash=max(min(hash,Paras[0].High),1); Paras[0].Val=hash;				// allocate benchmark table at once
+  sprintf(Cmd,"bench %d %d %d\n",max(depth,1),max(threads,1),hash);
+ }
+ else 																	// other commands: arguments as given
+ {
+  Cmd[0]=0;
+  for(i=0;i<n;i++) 
+   {strncat(Cmd,P[i],sizeof(Cmd)-strlen(Cmd)-2); strcat(Cmd,i<n-1?" ":"\n");}
+  if(depth&&!strcmp(P[0],"analyze"))									// depth limit of analysis
+   sprintf(Cmd+strlen(Cmd)-1," depth %d\n",depth);
+ }
+ if((i=CommandCode(Cmd))<50) 			return -1;						// console commands only
+ if((i==50)||(i==51)||(i==59)||(i==61))									// no search and no evaluation
+ {
+  Need=0; for(i=0;i<4;i++) Paras[i].Val=Paras[i].Low;					// smallest search tables
+  if(hash>0) Paras[108].Val=min(hash,Paras[108].High);					// perft table size
+ }
+ else if(hash>0) Paras[0].Val=min(hash,Paras[0].High);					// transposition table size
+ if(i==63) Need|=4;														// self play starts from book openings
+ PushCommand(strdup(Cmd)); PushCommand(strdup("quit\n"));				// run command and leave program
+ return Need;
 }
 
 void	SetGlobalDefaults()												// set global variables to initial default values
@@ -1124,7 +1592,7 @@ short	NNUE_Evaluate(Game* Gm, NNUE* Nn)								// NNUE evaluation function
 
  o+=(Nn->F_psq[our][buc]-Nn->F_psq[thr][buc])/2;						// new HalfKA version: add psqt value
  
- return (short)(o/Paras[106].Val);										// scale output			
+ return (short)(o/PAR(106));											// scale output			
 }
 
 void	NNUE_SpeedTest(Game* Gm, NNUE* Nn)
@@ -1169,11 +1637,272 @@ void 	ClearTables()													// clear all hashtables
  HASHFILL=TTACC=TTHIT1=TTHIT2=TTCUT=TTHLPR=0;							// reset statistics info 
  for(AM=0;AM<32*HEN;AM++) 		hash_t[AM]=0; 							// clear transposition table
  for(AM=0;AM<   HEN;AM++) 		hash_t[32*AM+1]|=4;						// set first entry bit
- for(AM=0;AM<40*PEN;AM++) 		phash_t[AM]=0;							// clear pawn/king evaluation hashtable	
- for(AM=0;AM< 8*MEN;AM++)		mhash_t[AM]=0;							// clear material hash table
+ ClearEvalTables();
+}
+
+void	ClearEvalTables()												// clear tables depending on evaluation parameters
+{
+ BitMap AM;
+ 
+ for(AM=0;AM<64*PEN;AM++) 		phash_t[AM]=0;							// clear pawn/king evaluation hashtable	
+ InitMaterial();															// material table of current parameters
  for(AM=0;AM< 8*EEN;AM++)  		ehash_t[AM]=0;							// clear evaluation hash table
 }
 
+Byte	*AllocTable(int MB)												// allocate cache line aligned table
+{
+#if defined(_WIN32)
+ return (Byte*)_aligned_malloc((size_t)MB*0x100000,64);
+#else
+ void	*T;
+ return posix_memalign(&T,64,(size_t)MB*0x100000)?NULL:(Byte*)T;
+#endif
+}
+
+void	FreeTable(Byte* T)												// free aligned table
+{
+#if defined(_WIN32)
+ _aligned_free(T);
+#else
+ free(T);
+#endif
+}
+
+void	SetHashSize(int MB)												// reallocate transposition table
+{
+ free(hash_t); Paras[0].Val=MB;											// free memory
+ HEN=(BitMap)(MB*0x100000)/32;											// number of TT entries
+ hash_t=(Byte*)(malloc(MB*0x100000+32));								// allocate memory for transposition table
+ ClearTables();															// clear new table
+}
+
+void	Bench(Byte d, Byte t, int MB)									// search benchmark positions to fixed depth
+{
+ Game		*Gm;
+ char		Fen[200];
+ BitMap		NOD=0;
+ double		t1,t2;
+ int		i,h=Paras[0].Val,n=Paras[93].Val,b1=Options[1].Val,b2=Options[2].Val;
+
+ if(MB!=h) SetHashSize(MB);												// hash size of benchmark
+ Paras[93].Val=t-1; Options[1].Val=Options[2].Val=false;				// helper threads, no books
+ Gm=(Game*)malloc(sizeof(Game));										// game structure of benchmark
+ t1=WallTime();															// start stopwatch
+ for(i=0;BenchFen[i];i++)
+ {
+  strcpy(Fen,"fen "); strcat(Fen,BenchFen[i]);							// fen of next position
+  InitNewGame(Gm); GetPosition(Gm,Fen);									// clear tables and history, set position
+  level=3; maxdepth=d; Ponder=false; Stop=false;						// fixed depth search
+  FlushOutput(); printf("\nPosition %d: %s\n",i+1,BenchFen[i]); fflush(stdout);
+  IterateSearch(Gm); NOD+=ALLNODES;										// search and count nodes
+ }
+ t2=WallTime()-t1; FlushOutput();										// stop stopwatch
+ printf("\n===========================\n");
+ printf("Total time (ms) : %.0lf\n",1000*t2);
+ printf("Nodes searched  : %llu\n",NOD);
+ printf("Nodes/second    : %.0lf\n",(double)(NOD)/t2); fflush(stdout);
+ free(Gm);
+ Paras[93].Val=n; Options[1].Val=b1; Options[2].Val=b2;					// restore settings
+ if(MB!=h) SetHashSize(h); else ClearTables();
+ SetGlobalDefaults();
+}
+
+void	Analyze(char* File, Byte lev, BitMap lim)						// analyze positions of epd file, one line of json each
+{
+ FILE		*fpr;
+ char		Line[500],**Fen=NULL;
+ Fbyte		N=0,Cap=0,*Next;
+ BitMap		*Nodes;
+ double		t1;
+ int		k,W,T=Paras[93].Val+1,h=Paras[0].Val,b1=Options[1].Val,b2=Options[2].Val;
+ 
+ if(!(fpr=fopen(File,"r"))) {printf("File does not exist!\n"); return;}	// open epd file for read
+ while(fgets(Line,500,fpr))												// read all positions
+ {
+  if(strlen(Line)<10) continue;											// empty line
+  if(N==Cap) {Cap=2*Cap+256; Fen=(char**)realloc(Fen,Cap*sizeof(char*));}
+  Fen[N++]=strdup(Line);
+ }
+ fclose(fpr);
+ W=max(1,min(T,(int)(N))); 												// one worker per thread, fewer for small files
+#if defined(_WIN32)
+ W=1; 																	// no worker processes: one SMP search
+ Next=(Fbyte*)malloc(sizeof(Fbyte)); Nodes=(BitMap*)malloc(sizeof(BitMap));
+#else
+ Next=(Fbyte*)mmap(NULL,64,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);// counters shared by workers
+ Nodes=(BitMap*)(Next+2);
+#endif
+ *Next=0; *Nodes=0;
+ Paras[93].Val=T/W-1; Options[1].Val=Options[2].Val=false; Quiet=true;	// SMP helpers per worker, no books
+ if(h/W!=h) SetHashSize(max(1,h/W));									// each worker gets a slice of the hash
+ FlushOutput(); fflush(stdout); t1=WallTime();							// nothing buffered twice
+#if !defined(_WIN32)
+ pid_t		Pid[W];
+ for(k=1;k<W;k++) if(!(Pid[k]=fork()))									// worker processes have private tables
+  {AnalyzeWorker(Fen,N,Next,Nodes,lev,lim); _exit(0);}
+#endif
+ AnalyzeWorker(Fen,N,Next,Nodes,lev,lim);								// this process is worker 0
+#if !defined(_WIN32)
+ for(k=1;k<W;k++) waitpid(Pid[k],NULL,0);								// wait for all workers
+#endif
+ t1=WallTime()-t1;
+ fprintf(stderr,"%llu positions, %d worker(s) with %d thread(s), %llu nodes in %.3lfs (%.0lf nodes/s)\n",
+ 	(BitMap)N,W,T/W,*Nodes,t1,(double)(*Nodes)/t1);
+ for(;N;N--) free(Fen[N-1]);
+ free(Fen);
+#if defined(_WIN32)
+ free(Next); free(Nodes);
+#else
+ munmap(Next,64);
+#endif
+ Paras[93].Val=T-1; Options[1].Val=b1; Options[2].Val=b2; Quiet=false;	// restore settings
+ if(Paras[0].Val!=h) SetHashSize(h); else ClearTables();
+ SetGlobalDefaults();
+}
+
+void	Gensfen(char* File, BitMap N, int nodes)						// generate training positions by self play
+{
+ FILE		*fp;
+ BitMap		*Count;
+ double		t1;
+ int		k,W=Paras[93].Val+1,h=Paras[0].Val,b1=Options[1].Val,b2=Options[2].Val;
+
+ if(!(fp=fopen(File,"wb"))) {printf("Cannot open %s!\n",File); return;}	// truncate output file
+ fclose(fp);
+#if defined(_WIN32)
+ W=1; Count=(BitMap*)malloc(sizeof(BitMap));							// no worker processes
+#else
+ Count=(BitMap*)mmap(NULL,64,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);// counter shared by workers
+#endif
+ *Count=0; Paras[93].Val=0; Quiet=true;									// single threaded searches
+ if(h/W!=h) SetHashSize(max(1,h/W));									// each worker gets a slice of the hash
+ printf("generating %llu positions with %d nodes per move in %d worker(s)\n",N,nodes,W);
+ FlushOutput(); fflush(stdout); t1=WallTime();							// nothing buffered twice
+#if !defined(_WIN32)
+ pid_t		Pid[W];
+ for(k=1;k<W;k++) if(!(Pid[k]=fork()))									// worker processes have private tables
+  {GensfenWorker(File,N,nodes,Count,k); _exit(0);}
+#endif
+ GensfenWorker(File,N,nodes,Count,0);									// this process is worker 0
+#if !defined(_WIN32)
+ for(k=1;k<W;k++) waitpid(Pid[k],NULL,0);								// wait for all workers
+#endif
+ t1=WallTime()-t1;
+ if(*Count>N) *Count=N;													// last buffers are cut
+ printf("\n%llu positions in %.1lfs (%.0lf positions/s, %.0lf per worker)\n",*Count,t1,*Count/t1,*Count/t1/W);
+#if defined(_WIN32)
+ free(Count);
+#else
+ munmap(Count,64);
+#endif
+ Paras[93].Val=W-1; Options[1].Val=b1; Options[2].Val=b2; Quiet=false;	// restore settings
+ if(Paras[0].Val!=h) SetHashSize(h); else ClearTables();
+ SetGlobalDefaults();
+}
+
+void	GensfenWorker(char* File, BitMap N, int nodes, BitMap* Count, Byte k)// play games until enough positions are written
+{
+ Game		*Gm;
+ Mvs		Mv;
+ Sfen		*Buf,*S;
+ FILE		*fp;
+ Dbyte		Mov,Rm[256];
+ Byte		c,i,t;
+ short		Val;
+ int		n=0,g,r,m;
+ BitMap		BM;
+ 
+ if(!(fp=fopen(File,"ab"))) 							return;			// records of all workers are appended
+ setvbuf(fp,NULL,_IONBF,0);												// one write per buffer
+ Gm=(Game*)malloc(sizeof(Game)); Buf=(Sfen*)malloc(4096*sizeof(Sfen));	// bounded record buffer
+ srand(time(NULL)+1009*k); InitNewGame(Gm);								// different openings in every worker
+ while(*Count<N)
+ {
+  GetPosition(Gm,Startpos); g=n;										// new game, first record of game
+  Options[1].Val=Options[2].Val=true;									// random book opening ...
+  for(i=0;(i<16)&&(Mov=Book(Gm));i++) Move(Gm,Mov&0xFFBF);
+  for(i=0;i<2;i++)														// ... and two random moves
+  {
+   GenMoves(Gm,&Mv); Mv.o=Mv.flg=m=0; Mv.s=200;
+   while((Mov=PickMove(Gm,&Mv))) Rm[m++]=Mov;
+   if(m) Move(Gm,Rm[rand()%m]);
+  }
+  if(Gm->Move_n) (Gm->Moves[Gm->Move_n-1]).check=TestCheck(Gm,(Gm->Officer[Gm->color][0]).square);
+  Options[1].Val=Options[2].Val=false; r=3;								// r: result for white+1, 3: undecided
+  while(r==3)
+  {
+   PlayMoves(Gm,NULL,(char*)"");										// root moves
+   c=Gm->color; t=(Gm->Officer[c][0]).square;
+   if(!(Gm->Root[0]).Mov) {r=TestCheck(Gm,t)?2*c:1; break;}				// mate or stalemate
+   if(DrawTest(Gm)||(Gm->Move_n>300)||!Gm->Matsig) {r=1; break;}		// draw, room for search plies in move list
+   level=4; MAXNODES=nodes; Ponder=false; Stop=false; Gm->Lastval=0;	// fixed nodes search
+   IterateSearch(Gm); Mov=Gm->Move2Make&0xFFBF; Val=Gm->Lastval;
+   if(Val>MaxScore-255||Val>3000) {r=2-2*c; break;}						// adjudicate win ...
+   if(Val<255-MaxScore||Val<-3000) {r=2*c; break;}						// ... and loss
+   if(ALLNODES&&!TestCheck(Gm,t)&&!(Gm->Piece[1-c][(Mov>>8)&63]).type	// searched quiet position
+   	 &&!(Mov&128)&&!(((Mov>>8)&63)==(Gm->Moves[Gm->Move_n]).ep&&(Gm->Piece[c][Mov&63]).type==6))
+   {
+    S=Buf+n++; PackSfen(Gm,S); S->Score=Val; S->Mov=Mov;				// pack position
+   }
+   Move(Gm,Mov); (Gm->Moves[Gm->Move_n-1]).check=TestCheck(Gm,(Gm->Officer[Gm->color][0]).square);
+  }
+  for(;g<n;g++) Buf[g].Flags|=(Buf[g].Flags&1?2-r:r)<<5;				// result for side to move
+  if(n>4096-301)														// no room for a game of up to 301 records: write
+  {
+   if((BM=__sync_fetch_and_add(Count,n))<N) fwrite(Buf,sizeof(Sfen),min(n,N-BM),fp);// not more than requested
+   n=0;
+   if(!k) fprintf(stderr,"%llu positions\n",*Count);					// progress
+  }
+ }
+ if(n&&((BM=__sync_fetch_and_add(Count,n))<N)) fwrite(Buf,sizeof(Sfen),min(n,N-BM),fp);
+ fclose(fp); free(Buf); free(Gm);
+}
+
+void	AnalyzeWorker(char** Fen, Fbyte N, Fbyte* Next, BitMap* Nodes, Byte lev, BitMap lim)
+{
+ Game		*Gm;
+ char		Pos[200],Ln[4096],Sm[10],F[6][100];
+ Fbyte		i;
+ int		l,n;
+ short		Val,Mm;
+ double		t1;
+ 
+ Gm=(Game*)malloc(sizeof(Game));										// game structure of worker
+ while((i=__sync_fetch_and_add(Next,1))<N)								// next position of file
+ {
+  F[4][0]=F[5][0]=0;
+  n=sscanf(Fen[i],"%99s %99s %99s %99s %99s %99s",F[0],F[1],F[2],F[3],F[4],F[5]);
+  if(n<4) continue;														// no fen
+  if((n<6)||!isdigit(F[4][0])||!isdigit(F[5][0])) 						// epd without move counters
+   {strcpy(F[4],"0"); strcpy(F[5],"1");}
+  snprintf(Pos,sizeof(Pos),"fen %s %s %s %s %s %s",F[0],F[1],F[2],F[3],F[4],F[5]);
+  InitNewGame(Gm); GetPosition(Gm,Pos); Gm->Lastval=0;					// clear tables and history, set position
+  level=lev; maxdepth=(lev==3)?min(lim,254):254; MAXNODES=lim; 			// depth, nodes or ...
+  Movetime=lim; Ponder=false; Stop=false;								// ... movetime limit
+  t1=WallTime(); IterateSearch(Gm); t1=WallTime()-t1;					// search
+  __sync_fetch_and_add(Nodes,ALLNODES);
+  Val=Gm->Lastval;
+  l=sprintf(Ln,"{\"id\":%llu,\"fen\":\"%s\",\"bestmove\":\"",(BitMap)i+1,Pos+4);	// json record
+  UncodeMove(Gm->Move2Make,Sm); Sm[strcspn(Sm," ")]=0; l+=sprintf(Ln+l,"%s\",\"score\":{",Sm);
+  if(Val>MaxScore-255) 		l+=sprintf(Ln+l,"\"mate\":%d}",(MaxScore-Val+1)/2);
+  else if(Val<255-MaxScore)	l+=sprintf(Ln+l,"\"mate\":-%d}",(Val+MaxScore+1)/2);
+  else 						l+=sprintf(Ln+l,"\"cp\":%d}",Val);
+  l+=sprintf(Ln+l,",\"depth\":%d,\"seldepth\":%d,\"nodes\":%llu,\"ms\":%.0lf,\"pv\":[",
+  	min(Gm->idepth,maxdepth),Gm->Maxply,ALLNODES,1000*t1);
+  GetPV(Gm); Mm=Gm->Move_r;												// principal variation
+  if((Gm->Moves[Mm]).Mov!=Gm->Move2Make) 								// no pv: best move only
+   {(Gm->Moves[Mm]).Mov=Gm->Move2Make; (Gm->Moves[Mm+1]).Mov=0;}
+  while(((Gm->Moves[Mm]).Mov)&&(l<(int)sizeof(Ln)-20))
+  {
+   UncodeMove((Gm->Moves[Mm]).Mov,Sm); Sm[strcspn(Sm," ")]=0;
+   l+=sprintf(Ln+l,"%s\"%s\"",Mm>Gm->Move_r?",":"",Sm); Mm++;
+  }
+  l+=sprintf(Ln+l,"]}\n");
+  if(write(1,Ln,l)<0) break;											// one write per record keeps lines whole
+ }
+ free(Gm);
+}
+
 void 	InitNewGame(Game* Gm)											// initialize a new game
 {
  Byte 	j,k,l;
@@ -1202,19 +1931,27 @@ void 	InitNewGame(Game* Gm)											// initialize a new game
 void 	GetPosition(Game* Gm,char* Mo)									// gets position information from input
 {
  char* 	St;
+
+ if((St=strstr(Mo,"fen"))) ParseFen(Gm,St+4);							// read new position
+ else ParseFen(Gm,Startpos);											// startposition
+ if(!(St=strstr(Mo,"moves"))) St=(char*)"";								// no moves
+ PlayMoves(Gm,NULL,St);													// read moves of game
+}
+
+void	PlayMoves(Game* Gm, NNUE* Nn, char* St)							// makes moves of list and sets root moves
+{
  Dbyte 	Mov;
  Mvs  	Mv;
  Byte	i;
- 
- if((St=strstr(Mo,"fen"))) ParseFen(Gm,St+4);							// read new position
- else ParseFen(Gm,Startpos);											// startposition
- if((St=strstr(Mo,"moves"))) while((St=strchr(St,' '))) 				// read moves of game
+
+ while((St=strchr(St,' '))) 											// read moves of game
  {
   while(*++St==' ');													// remove leading spaces
   if((*St<'a') || (*St>'h')) break;										// finished
   if((Mov=CodeMove(Gm,St))) 											// no nullmove
   {
    Move(Gm,Mov); 														// make move
+   if(Nn) NNUE_UpdateFeatures(Gm,Nn);									// update NNUE features
    (Gm->Moves[Gm->Move_n-1]).check=										// set check flag
    					TestCheck(Gm,(Gm->Officer[Gm->color][0]).square);	
   }
@@ -1227,78 +1964,437 @@ void 	GetPosition(Game* Gm,char* Mo)									// gets position information from i
   {(Gm->Root[i]).Order=1; (Gm->Root[i]).flags=0; i++;}					// fill root move list		    
 }
 
-double	CompareEval(char* csv, short limit, int pos)
+void	SetPosition(Game* Gm, NNUE* Nn, char* Mo)						// position command, new moves only if possible
+{
+ Fbyte	l=strlen(Mo),k;
+ char	*St;
+
+ while(l&&isspace(Mo[l-1])) Mo[--l]=0;									// remove line end
+ k=PosCmd?strlen(PosCmd):0;
+ if(k&&(l>k)&&(Mo[k]==' ')&&!strncmp(Mo,PosCmd,k)&&						// previous command is prefix of new command,
+ 	(strstr(PosCmd," moves")||!strncmp(Mo+k+strspn(Mo+k," "),"moves",5))&&	// new part is a list of moves
+ 	(PosHash==(Gm->Moves[Gm->Move_n]).HASH))							// and game has not changed since
+ {
+  if(!(St=strstr(Mo+k,"moves"))) St=Mo+k;								// first new move
+  PlayMoves(Gm,Options[8].Val?Nn:NULL,St);								// make new moves only
+ }
+ else
+ {
+  GetPosition(Gm,Mo);													// set up position and all moves
+  if(Options[8].Val) NNUE_InitFeatures(Gm,Nn,3);          				// init NNUE features
+ }
+ if(l+1>PosCap) {PosCap=2*l+1; PosCmd=(char*)realloc(PosCmd,PosCap);}	// remember command
+ strcpy(PosCmd,Mo); PosHash=(Gm->Moves[Gm->Move_n]).HASH;
+}
+
+char	*ReadLine(char** Str, Fbyte* Cap)								// reads line of any length from stdin
+{
+ Fbyte	l=0;
+
+ (*Str)[0]=0;
+ while(fgets(*Str+l,*Cap-l,stdin))										// read next part of line
+ {
+  l+=strlen(*Str+l); if(l&&((*Str)[l-1]=='\n')) return *Str;			// line complete
+  if(l+1>=*Cap) {*Cap*=2; *Str=(char*)realloc(*Str,*Cap);}				// enlarge buffer
+ }
+ return l?*Str:NULL;													// end of input
+}
+
+char	*MapFile(char* Name, BitMap* Size)								// map file read only into memory
+{
+ char	*F;
+#if defined(_WIN32)
+ FILE 	*fp;
+ if(!(fp=fopen(Name,"rb"))) 							return NULL;
+ fseek64(fp,0,SEEK_END); *Size=ftell64(fp); fseek64(fp,0,SEEK_SET);		// 64 bit size (files > 4 GB)
+ F=(char*)malloc(*Size+1); *Size=fread(F,1,*Size,fp); fclose(fp);		// windows: read file into memory
+ if(!*Size) {free(F);									return NULL;}
+#else
+ int	fd;
+ struct stat St;
+ if(((fd=open(Name,O_RDONLY))<0)||fstat(fd,&St)||!St.st_size)			// empty files cannot be mapped
+  {if(fd>=0) close(fd);									return NULL;}
+ *Size=St.st_size; F=(char*)mmap(NULL,*Size,PROT_READ,MAP_PRIVATE,fd,0); close(fd);// pages are loaded on demand
+ if(F==MAP_FAILED) 										return NULL;
+#endif
+ return F;
+}
+
+void	UnmapFile(char* F, BitMap Size)									// release mapped file
 {
- Game	Gm;
+#if defined(_WIN32)
+ free(F);
+#else
+ munmap(F,Size);
+#endif
+}
+
+void	SplitLines(char* F, char* End, int T, char** B)					// split range into T parts B[i]..B[i+1] at line ends
+{
+ int	i;
+
+ for(B[0]=F,i=1;i<=T;i++)
+ {
+  B[i]=F+(End-F)*i/T;
+  while((B[i]<End)&&(B[i][-1]!='\n')) B[i]++;							// part ends behind a line feed
+  if(B[i]<B[i-1]) B[i]=B[i-1];
+ }
+}
+
+bool	CsvLine(char* L, char* E, char* Pos, int* Val)					// fen and evaluation of csv line, line is not terminated
+{
+ char	Num[16],*Is;
+ int	l,m;
+
+ if(!(Is=(char*)memchr(L,',',E-L))) 					return false;	// no comma in line
+ if(memchr(Is+1,'#',E-Is-1)) 							return false;	// no mate evaluations
+ m=min(E-Is-1,15); memcpy(Num,Is+1,m); Num[m]=0;
+ if(sscanf(Num,"%d",Val)!=1)	 						return false;	// no evaluation in line
+ if((l=(int)(Is-L))>100) 								return false;	// fen too long
+ memcpy(Pos,L,l); Pos[l]=0;
+ for(m=0,Is=Pos;*Is;Is++) m+=(*Is==' ');								// epd without move counters
+ if(m<5) strcat(Pos," 0 1");
+ return true;
+}
+
+void	*CompareWorker(void *Pe)										// compare evaluations of a range of the csv file
+{
+ Cwork	*C=(Cwork*)(Pe);
+ Game	*Gm;
  Mvs	Mv;
  NNUE	Nn;
- double	Diff=0;
- FILE 	*fpr;
- char	Line[200],Pos[100];
- char	*Is;
- int	Val,Eval,i,n=0;
- 
- if(!(fpr=fopen(csv,"r"))) {printf("File does not exist!\n"); return 0;}// open csv file for read
- printf("Comparing static evaluation for positions in file %s ...\n",csv);
-
- while((fgets(Line,200,fpr))&&(n<pos))
- {
-  if(!(Is=strstr(Line,","))) 					continue;				// no comma in line
-  if(strstr(Is+1,"#")) 							continue;				// no mate evaluations
-  if(!sscanf(Is+1,"%d",&Val)) 					continue;				// no evaluation in line
-  if((Val>limit)||(Val<-limit)) 				continue;				// limit exceeded
-  strcpy(Pos,Line); ParseFen(&Gm,Pos); GenMoves(&Gm,&Mv);				// get position and moves 
-  Eval=Evaluation(&Gm,&Nn,&Mv,-MaxScore,MaxScore);						// calculate evaluation
-  if(Gm.color) Eval=-Eval;												// change to black/white format
-  if((Eval>limit)||(Eval<-limit)) 				continue;				// limit exceeded									
-  printf("Val: %d Eval: %d Diff: %f\n",Val,Eval,sqrt((double)(Val-Eval)*(double)(Val-Eval)));
-  n++; Val-=Eval; Diff+=sqrt((double)(Val)*(double)(Val));				// subtract static evaluation
- }
- if(!n) printf("No position meets the limit!\n");
- else printf("Average eval difference of %d positions: %5.0f\n",n,Diff/n);// print average difference
- 													
- fclose(fpr);	
+ char	Pos[120],*L,*E;
+ int	Val,Eval;
+
+ Gm=(Game*)malloc(sizeof(Game)); C->n=0; C->Diff=0;						// game structure of thread
+ for(L=C->Start;L<C->End;L=E+1)											// all lines of range
+ {
+  if(!(E=(char*)memchr(L,'\n',C->End-L))) E=C->End;						// end of line
+  if(!CsvLine(L,E,Pos,&Val)) 					continue;				// no fen and evaluation in line
+  if((Val>C->limit)||(Val<-C->limit)) 			continue;				// limit exceeded
+  ParseFen(Gm,Pos); Mv.cp=NOMOVES;										// get position, evaluation generates moves if needed
+  if(Options[8].Val) NNUE_InitFeatures(Gm,&Nn,3);						// NNUE features of position
+  Eval=Evaluation(Gm,&Nn,&Mv,-MaxScore,MaxScore);						// calculate evaluation
+  if(Gm->color) Eval=-Eval;												// change to black/white format
+  if((Eval>C->limit)||(Eval<-C->limit)) 		continue;				// limit exceeded									
+  if(C->v) printf("Val: %d Eval: %d Diff: %d\n",Val,Eval,abs(Val-Eval));
+  C->n++; C->Diff+=abs(Val-Eval);										// absolute difference
+ }
+ free(Gm);
+ return NULL;
+}
+
+double	CompareEval(char* csv, short limit, int pos, Byte v)			// average difference of static eval and csv evals
+{
+ Cwork	C[Paras[93].Val+1];
+ char	*F,*L,*E,*End,*B[Paras[93].Val+2],Pos[120];
+ BitMap	Size;
+ double	Diff=0,t1;
+ int	i,n=0,T=Paras[93].Val+1,Val;
+ 
+ if(!(F=MapFile(csv,&Size))) {printf("File does not exist!\n"); return 0;}// open csv file for read
+ printf("Comparing static evaluation for positions in file %s using %d thread(s) ...\n",csv,T);
+ t1=WallTime();
+ for(L=F,End=F+Size;(L<End)&&(n<pos);L=E+1)							// first pos lines with csv eval in limit
+ {
+  if(!(E=(char*)memchr(L,'\n',End-L))) E=End;
+  if(CsvLine(L,E,Pos,&Val)&&(Val<=limit)&&(Val>=-limit)) n++;
+ }
+ End=min(L,F+Size); SplitLines(F,End,T,B);								// range of the file to compare
+ for(i=0;i<T;i++)														// one part per thread
+ {
+  C[i].Start=B[i]; C[i].End=B[i+1]; C[i].limit=limit; C[i].v=v;
+  pthread_create(&(C[i].Tid),NULL,CompareWorker,(void*)(C+i));
+ }
+ for(n=i=0;i<T;i++) 													// reduce statistics of threads
+  {pthread_join(C[i].Tid,NULL); n+=C[i].n; Diff+=C[i].Diff;}
+ UnmapFile(F,Size);
+ if(!n) {printf("No position meets the limit!\n"); return 0;}
+ printf("Average eval difference of %d positions: %5.0f (%.0lf positions/s)\n",n,Diff/n,n/(WallTime()-t1));
  return Diff/n;	
 }
 
-void	ParseParameters(char* csv, int n)
+void	PackSfen(Game* Gm, Sfen* S)										// pack position into training record
 {
- Byte	i,j,k;
- double	DiffO,DiffP,Diff;
- 
- printf("Testing variations of evaluation parameters with data from file %s ...\n",csv);
- DiffO=DiffP=CompareEval(csv,1000,n); printf("\n");
- 
- for(i=0;i<sizeof(Paras)/sizeof(Paras[0]);i++) if(Paras[i].Change)		// parse changeable parameters
+ Byte	i,m=0;
+ BitMap	BM;
+
+ memset(S,0,sizeof(Sfen));
+ S->Occ=Gm->POSITION[0][0]|Gm->POSITION[1][0];
+ for(i=0,BM=1;i<64;i++,BM<<=1) if(S->Occ&BM)
+  {S->Pc[m/2]|=((Gm->Piece[0][i]).type|((Gm->Piece[1][i]).type+8*!(Gm->Piece[0][i]).type))<<(4*(m&1)); m++;}
+ S->Flags=Gm->color|(((Gm->Moves[Gm->Move_n]).castles&15)<<1);			// castle rights without castled flags
+ S->Ep=(Gm->Moves[Gm->Move_n]).ep; S->Ply=Gm->Move_n;
+}
+
+void	UnpackSfen(Sfen* S, char* Fen)									// fen string of training record
+{
+ Byte	i,m=0,e=0;
+
+ for(i=0;i<64;i++)
  {
-  if(Paras[i].Val+Paras[i].Change<=Paras[i].High)
+  if(S->Occ>>i&1) 														// piece on square
   {
-   printf("Changing parameter %s from %d to %d ...\n",
-   			Paras[i].Name,Paras[i].Val,Paras[i].Val+Paras[i].Change);
-   Paras[i].Val+=Paras[i].Change; ClearTables(); Diff=CompareEval(csv,1000,n); 
-   Paras[i].Val-=Paras[i].Change; if(Diff<DiffP) {DiffP=Diff; j=i; k=1;} 
-   printf("\n");
+   if(e) {*Fen++='0'+e; e=0;}
+   *Fen++="?KQRBNP??kqrbnp?"[(S->Pc[m/2]>>(4*(m&1)))&15]; m++;
   }
-  if(Paras[i].Val-Paras[i].Change>=Paras[i].Low)
+  else e++;																// empty squares
+  if((i&7)==7) {if(e) {*Fen++='0'+e; e=0;} if(i<63) *Fen++='/';}		// end of rank
+ }
+ *Fen++=' '; *Fen++=S->Flags&1?'b':'w'; *Fen++=' ';
+ if(!(S->Flags&30)) *Fen++='-';											// castle rights
+ for(i=0;i<4;i++) if(S->Flags&(2<<i)) *Fen++="KQkq"[i];
+ if(S->Ep) sprintf(Fen," %c%c 0 1",'a'+(S->Ep&7),'8'-(S->Ep>>3));		// ep square
+ else	   sprintf(Fen," - 0 1");
+}
+
+#if !defined(CONST_PARAS)												// tuner only for changeable parameters
+bool	QuietLeaf(Game* Gm, NNUE* Nn)									// play quiescence search PV to its leaf
+{
+ Mvs	Mv;
+ Dbyte	Mov,Best;
+ short	Ev,v;
+ Byte	d;
+
+ for(d=0;d<32;d++)														// captures of the principal variation
+ {
+  if(TestCheck(Gm,99))									return false;	// no positions in check
+  GenMoves(Gm,&Mv); if(!Mv.cp)							return false;	// mate or stalemate
+  Ev=Evaluation(Gm,Nn,&Mv,-MaxScore,MaxScore); Best=0;					// static evaluation is stand pat
+  Gm->Move_r=Gm->Move_n; Mv.o=Mv.flg=0; Mv.s=200;						// all legal moves
+  while((Mov=PickMove(Gm,&Mv)))
+   if((Gm->Piece[1-Gm->color][(Mov>>8)&63]).type||(Mov&128))			// captures and promotions
+   {
+    Move(Gm,Mov); v=-Qsearch(Gm,Nn,-MaxScore,-Ev,0); UnMove(Gm);
+    if(v>Ev) {Ev=v; Best=Mov;}											// quiescence search improves stand pat
+   }
+  if(!Best) 											return true;	// quiet leaf reached
+  Move(Gm,Best);														// follow best capture
+ }
+ return false;
+}
+
+void	*ConvertWorker(void *Pe)										// convert a range of the csv file to quiet records
+{
+ Twork	*T=(Twork*)(Pe);
+ Game	*Gm;
+ NNUE	Nn;
+ char	Pos[120],*L,*E;
+ int	Val;
+ Fbyte	m=4096;
+
+ Gm=(Game*)malloc(sizeof(Game)); T->S=(Sfen*)malloc(m*sizeof(Sfen)); T->n=0;
+ for(L=T->Start;L<T->End;L=E+1)											// all lines of range
+ {
+  if(!(E=(char*)memchr(L,'\n',T->End-L))) E=T->End;						// end of line
+  if(!CsvLine(L,E,Pos,&Val)) 					continue;				// no fen and evaluation in line
+  if((Val>3000)||(Val<-3000)) 					continue;				// decided positions
+  ParseFen(Gm,Pos);
+  if(!QuietLeaf(Gm,&Nn))						continue;				// check or mate on the way
+  if(T->n==m) T->S=(Sfen*)realloc(T->S,(m*=2)*sizeof(Sfen));
+  PackSfen(Gm,T->S+T->n); (T->S[T->n++]).Score=Gm->color?-Val:Val;		// target value for stm
+ }
+ free(Gm);
+ return NULL;
+}
+
+void	*TuneWorker(void *Pe)											// evaluate a range of training records
+{
+ Twork	*T=(Twork*)(Pe);
+ Game	*Gm;
+ Mvs	Mv;
+ NNUE	Nn;
+ Ecoef	C[sizeof(Paras)/sizeof(Paras[0])];
+ char	Pos[120];
+ Fbyte	i,m=4096;
+ Byte	j,n,gp,k;
+ short	v;
+
+ Gm=(Game*)malloc(sizeof(Game)); T->m=0;
+ if(T->K) T->C=(Tcoef*)malloc(m*sizeof(Tcoef));
+ for(i=0;i<T->n;i++)
+ {
+  UnpackSfen(T->S+i,Pos); ParseFen(Gm,Pos); Mv.cp=NOMOVES;				// get position, moves on demand
+  if(!T->K) {T->E[i]=Evaluation(Gm,&Nn,&Mv,-MaxScore,MaxScore); continue;}// evaluation for stm
+  n=EvalCoefficients(Gm,&Mv,C,&v); gp=min(24,Gm->phase);				// coefficients in one evaluation
+  for(j=0;j<n;j++) if((k=T->K[C[j].Par])!=255)							// tuned parameters
   {
-   printf("Changing parameter %s from %d to %d ...\n",
-   			Paras[i].Name,Paras[i].Val,Paras[i].Val-Paras[i].Change);
-   Paras[i].Val-=Paras[i].Change; ClearTables(); Diff=CompareEval(csv,1000,n);
-   Paras[i].Val+=Paras[i].Change; if(Diff<DiffP) {DiffP=Diff; j=i; k=2;}
-   printf("\n");
+   if(T->m==m) T->C=(Tcoef*)realloc(T->C,(m*=2)*sizeof(Tcoef));
+   T->C[T->m].i=i; T->C[T->m].k=k;										// tapered eval change per step
+   T->C[T->m++].v=(C[j].Op*gp+C[j].Eg*(24-gp))/24*Paras[C[j].Par].Change;
   }
  }
- printf("Finished! ");
- if(DiffP<DiffO)
- { 
-  if(k==1) printf("Suggesting to change parameter %s from %d to %d ",
-  			Paras[j].Name,Paras[j].Val,Paras[j].Val+Paras[j].Change);
-  else	   printf("Suggesting to change parameter %s from %d to %d!\n",
-  			Paras[j].Name,Paras[j].Val,Paras[j].Val-Paras[j].Change);
-  printf("to achieve %3.0f cp improvement!\n",DiffO-DiffP);
+ free(Gm);
+ return NULL;
+}
+
+void	TuneEvals(Sfen* S, Fbyte N, float* E)							// evaluate all training records
+{
+ Twork	T[Paras[93].Val+1];
+ int	i,t=Paras[93].Val+1;
+
+ ClearEvalTables();														// tables hold values of old parameters
+ for(i=0;i<t;i++)														// split records among threads
+ {
+  T[i].S=S+N*i/t; T[i].n=N*(i+1)/t-N*i/t; T[i].E=E+N*i/t; T[i].K=NULL;
+  pthread_create(&(T[i].Tid),NULL,TuneWorker,(void*)(T+i));
+ }
+ for(i=0;i<t;i++) pthread_join(T[i].Tid,NULL);
+}
+
+void	TuneCoefs(Sfen* S, Fbyte N, Byte* K, Byte n, Fbyte** Ci, float** Cv, Fbyte* Cn)// linear coefficients of all training records
+{
+ Twork	T[Paras[93].Val+1];
+ Fbyte	j,o;
+ int	i,t=Paras[93].Val+1;
+ Byte	k;
+
+ for(i=0;i<t;i++)														// split records among threads
+ {
+  T[i].S=S+N*i/t; T[i].n=N*(i+1)/t-N*i/t; T[i].K=K;
+  pthread_create(&(T[i].Tid),NULL,TuneWorker,(void*)(T+i));
+ }
+ for(i=0;i<t;i++) pthread_join(T[i].Tid,NULL);
+ for(k=0;k<n;k++) Cn[k]=0;												// rows of records ...
+ for(i=0;i<t;i++) for(j=0;j<T[i].m;j++) Cn[T[i].C[j].k]++;
+ for(k=0;k<n;k++) {Ci[k]=(Fbyte*)realloc(Ci[k],Cn[k]*sizeof(Fbyte)+1); Cv[k]=(float*)realloc(Cv[k],Cn[k]*sizeof(float)+1); Cn[k]=0;}
+ for(i=0;i<t;i++)														// ... to sparse columns of parameters
+ {
+  for(o=T[i].S-S,j=0;j<T[i].m;j++)
+   {k=T[i].C[j].k; Ci[k][Cn[k]]=o+T[i].C[j].i; Cv[k][Cn[k]++]=T[i].C[j].v;}
+  free(T[i].C);
+ }
+}
+
+double	TuneLoss(Sfen* S, Fbyte N, float* E)							// mean squared error of winning probabilities
+{
+ double	L=0,K=log(10.0)/400;
+ Fbyte	i;
+
+ for(i=0;i<N;i++) L+=pow(1/(1+exp(-K*E[i]))-1/(1+exp(-K*S[i].Score)),2);
+ return L/N;
+}
+
+void	Tune(char* File, Fbyte pos, int iter)							// texel tuning of evaluation parameters
+{
+ Twork	T[Paras[93].Val+1];
+ FILE	*fp;
+ Sfen	*S=NULL;
+ Fbyte	N=0,i,j,*Ci[128],Cn[128];
+ float	*E0,*Cv[128];
+ double	K=log(10.0)/400,*e,*r,g,z[128],m1[128],m2[128],L0,L1=0,Lb=0,Sg,t1,Rg=4;
+ short	Old[128],Best[128],Hi,Lo,Cur;
+ Byte	P[128],Ti[128],n=0,k,p,b=Options[8].Val,lv=level;
+ int	t=Paras[93].Val+1,it,st,c;
+ char	Cache[256];
+ BitMap	Key[4]={TUNEMAGIC,0,0,pos},H[4]={0,0,0,0};
+ struct stat St;
+
+ snprintf(Cache,sizeof(Cache),"%s.bin",File); t1=WallTime();
+ if(!stat(File,&St)) {Key[1]=St.st_size; Key[2]=St.st_mtime;}			// cache is valid for this csv file and pos only
+ if((strlen(File)>4)&&!strcmp(File+strlen(File)-4,".bin")) strcpy(Cache,File);// records of gensfen or earlier conversion
+ if((fp=fopen(Cache,"rb")))												// converted records are read once
+ {
+  fseek64(fp,0,SEEK_END); N=ftell64(fp)/sizeof(Sfen); fseek64(fp,0,SEEK_SET);
+  if(N&&(fread(H,sizeof(H),1,fp)==1)&&(H[0]==TUNEMAGIC)) N--;			// header of converted csv file ...
+  else fseek(fp,0,SEEK_SET);											// ... or gensfen records
+  if(strcmp(Cache,File)&&memcmp(H,Key,sizeof(Key))) N=0;				// csv file or pos changed since conversion
+  if(pos&&(pos<N)) N=pos;
+  S=(Sfen*)malloc(N*sizeof(Sfen)+1); N=fread(S,sizeof(Sfen),N,fp); fclose(fp);
+  if(N) printf("%llu training positions read from %s\n",(BitMap)N,Cache);
+  else {free(S); S=NULL;}
+ }
+ if(!N&&strcmp(Cache,File))												// convert csv file to quiet records
+ {
+  char	*F,*L,*E,*End,*B[Paras[93].Val+2];
+  BitMap	Size;
+
+  if(!(F=MapFile(File,&Size))) {printf("File does not exist!\n"); return;}// open csv file for read
+  printf("Converting %s to quiet positions using %d thread(s) ...\n",File,t);
+  for(L=F,End=F+Size,i=0;(L<End)&&(!pos||(i<pos));L=E+1,i++)			// first pos lines
+   if(!(E=(char*)memchr(L,'\n',End-L))) E=End;
+  End=min(L,F+Size); SplitLines(F,End,t,B);
+  Options[8].Val=false; Tmax=0; level=0; Stop=false;					// unlimited quiescence searches
+  for(c=0;c<t;c++)														// one part per thread
+  {
+   T[c].Start=B[c]; T[c].End=B[c+1];
+   pthread_create(&(T[c].Tid),NULL,ConvertWorker,(void*)(T+c));
+  }
+  for(c=0;c<t;c++) {pthread_join(T[c].Tid,NULL); N+=T[c].n;}
+  S=(Sfen*)malloc(N*sizeof(Sfen)+1);									// join records in file order
+  for(c=0,N=0;c<t;c++) {memcpy(S+N,T[c].S,T[c].n*sizeof(Sfen)); N+=T[c].n; free(T[c].S);}
+  UnmapFile(F,Size);
+  if((fp=fopen(Cache,"wb"))) {fwrite(Key,sizeof(Key),1,fp); fwrite(S,sizeof(Sfen),N,fp); fclose(fp);}// header with csv size, time and pos
+  printf("%llu quiet positions in %.1lfs, cached in %s\n",(BitMap)N,WallTime()-t1,Cache);
+ }
+ if(!N) {printf("No training positions!\n"); free(S); Options[8].Val=b; level=lv; return;}
+
+ Options[8].Val=false;													// NNUE does not use the parameters
+ for(i=0;i<sizeof(Paras)/sizeof(Paras[0]);i++)							// tunable parameters
+ {
+  Ti[i]=255;
+  if(Paras[i].Change&&(Paras[i].Low<Paras[i].High)&&(n<128)) {Old[n]=Paras[i].Val; Ti[i]=n; P[n++]=i;}
+ }
+ E0=(float*)malloc(N*sizeof(float));
+ e=(double*)malloc(2*N*sizeof(double)); r=e+N;
+ for(k=0;k<n;k++) {Ci[k]=NULL; Cv[k]=NULL;}
+ printf("Tuning %d parameters with %llu positions using %d thread(s) ...\n",n,(BitMap)N,t);
+
+ for(it=0;;it++)
+ {
+  TuneEvals(S,N,E0); L0=TuneLoss(S,N,E0);								// loss of current parameters
+  if(it&&(L0>=Lb))														// linear model was wrong for these steps
+  {
+   for(k=0;k<n;k++) Paras[P[k]].Val=Best[k];
+   Rg/=2; printf("Iteration %d: loss %.7lf rejected (%.0lfs)\n",it,L0,WallTime()-t1);
+   if((it==iter)||(Rg<0.25)) 					break;
+   TuneEvals(S,N,E0); L0=Lb;
+  }
+  else
+  {
+   Lb=L0; for(k=0;k<n;k++) Best[k]=Paras[P[k]].Val;
+   printf("Iteration %d: loss %.7lf (%.0lfs)\n",it,L0,WallTime()-t1);
+   if(it==iter) 								break;
+  }
+  TuneCoefs(S,N,Ti,n,Ci,Cv,Cn);											// linearize evaluation in one traced pass
+  for(k=0;k<n;k++) z[k]=m1[k]=m2[k]=0;									// parameter changes in steps
+  for(st=1;st<=300;st++)												// adam on linear model
+  {
+   for(i=0;i<N;i++) e[i]=E0[i];
+   for(k=0;k<n;k++) if(z[k]) for(j=0;j<Cn[k];j++) e[Ci[k][j]]+=z[k]*Cv[k][j];
+   for(L1=0,i=0;i<N;i++)												// derivative of loss for eval
+   {
+    Sg=1/(1+exp(-K*e[i])); g=Sg-1/(1+exp(-K*S[i].Score));
+    L1+=g*g; r[i]=2*g*K*Sg*(1-Sg)/N;
+   }
+   for(k=0;k<n;k++)
+   {
+    for(g=0,j=0;j<Cn[k];j++) g+=r[Ci[k][j]]*Cv[k][j];					// gradient of parameter
+    m1[k]=0.9*m1[k]+0.1*g; m2[k]=0.999*m2[k]+0.001*g*g;
+    z[k]-=0.05*(m1[k]/(1-pow(0.9,st)))/(sqrt(m2[k]/(1-pow(0.999,st)))+1e-12);
+    p=P[k]; Lo=Paras[p].Low-Paras[p].Val; Hi=Paras[p].High-Paras[p].Val;// keep parameter in range ...
+    z[k]=max(z[k],max(-Rg,(double)Lo/Paras[p].Change));				// ... and in region of linearization
+    z[k]=min(z[k],min( Rg,(double)Hi/Paras[p].Change));
+   }
+  }
+  for(c=k=0;k<n;k++)													// apply rounded changes
+  {
+   p=P[k]; Cur=Paras[p].Val+(short)lround(z[k]*Paras[p].Change);
+   Cur=max(Paras[p].Low,min(Paras[p].High,Cur));
+   if(Cur!=Paras[p].Val) {Paras[p].Val=Cur; c++;}
+  }
+  printf("Iteration %d: %d parameter(s) changed, linear model loss %.7lf\n",it+1,c,L1/N);
+  if(!c) 										break;
  }
- else printf("Suggesting not to change any parameters!\n");
+ printf("Finished in %.0lfs, loss %.7lf\n",WallTime()-t1,Lb);
+ for(c=k=0;k<n;k++) if(Paras[P[k]].Val!=Old[k])							// parameters are kept
+  {printf("setoption name %s value %d (was %d)\n",Paras[P[k]].Name,Paras[P[k]].Val,Old[k]); c++;}
+ if(!c) printf("Suggesting not to change any parameters!\n");
+ for(k=0;k<n;k++) {free(Ci[k]); free(Cv[k]);}
+ free(e); free(E0); free(S);
+ Options[8].Val=b; level=lv; ClearTables();
 }
+#endif
 
 bool 	TestAttk(Game* Gm, Byte k, Byte t, Byte c)						// test if piece type k attacks higher piece  on square t 
 {
@@ -1329,6 +2425,12 @@ bool 	TestCheck(Game* Gm, Byte k)										// tests if check on square k
  BitMap PM;
 
  if(k==99) k=(Gm->Officer[Gm->color][0]).square;						// square is king's position
+#if defined(USE_ATTACKS)
+ PM=A8<<k; if(STEP[4-c][k]&Gm->POSITION[c][6]) 			return true;	// pawn checks
+ for(k=0;k<(Gm->Count[c]).officers;k++)									// officers' attacks from table
+  if(Gm->ATKF[(Gm->Officer[c][k]).square]&PM) 			return true;
+ return false;
+#endif
  if(STEP[2][k]&Gm->POSITION[c][5]) 						return true;	// knight checks
  if(STEP[4-c][k]&Gm->POSITION[c][6]) 					return true;	// pawn checks
  if(PM=Gm->POSITION[c][2]|Gm->POSITION[c][3])							// queens and rooks
@@ -1405,7 +2507,8 @@ void 	PrintPosition(Game* Gm, NNUE* Nn)								// print board
    printf("%s",Mo); if((Gm->Moves[i]).check) printf("+"); printf(" ");	// print move and check symbol 
   }
   printf("\nposition hash: %llu\n",(Gm->Moves[Gm->Move_n]).HASH);		// transpostition hash
-  printf("material hash: %llu\n",Gm->MHASH);							// material hash
+  if(Gm->Mexc) printf("material key: beyond table range\n");			// material key
+  else printf("material key: %lu scale: %d\n",Gm->MKEY,mat_t[Gm->MKEY].Scale);
   printf("pawn hash: %llu\n",Gm->PHASH);								// pawn hash
   printf("material signature white: %X black: %X \n",Gm->Matsig&0x1F,	// material signature
    		 (Gm->Matsig>>5)&0x1F);
@@ -1436,7 +2539,8 @@ void 	ParseFen(Game *Gm, char *fen)									// scans fen string and sets all var
  BitMap BS;
 
  Gm->phase=0; Gm->Move_n=0; Gm->Matsig=0; Gm->Lastbest=0;				// initialize game parameters										
- (Gm->Moves[0]).HASH=0; Gm->PHASH=0; Gm->MHASH=0; BS=1;					// initialize hash values
+ Gm->Trace=NULL;														// no evaluation trace
+ (Gm->Moves[0]).HASH=0; Gm->PHASH=0; Gm->MKEY=Gm->Mexc=0; BS=1;			// initialize hash values and material key
  
  for(j=0;j<2;j++)														// initialize game structure
  {
@@ -1464,7 +2568,8 @@ void 	ParseFen(Game *Gm, char *fen)									// scans fen string and sets all var
    if(l<6) ((Gm->Count[c]).officers)++; else ((Gm->Count[c]).pawns)++;	// increment piece counters
    (Gm->Psv[c]).Open+=Square[c][l-1][0][i];								// piece square material value opening
    (Gm->Psv[c]).End +=Square[c][l-1][1][i];								// piece square material value endgame
-   Gm->MHASH+=RANDOM_B[c][l-1][0];										// add piece to material hash 
+   Gm->MKEY+=MatW[c][l][(WS>>i)&1];										// add piece to material key
+   if((l>1)&&(l<6)&&MatExcess(Gm->POSITION[c][l],l,i)) (Gm->Mexc)++;	// piece beyond table range
    if(l>1) Gm->Matsig|=(1<<(5*c+l-2));									// set piece in material signature
    if(l==2) Gm->phase+=4; if(l==3) Gm->phase+=2;						// game phase (q=4,r=2,b,n=1)
    if((l==4)||(l==5)) (Gm->phase)++;
@@ -1496,23 +2601,36 @@ void 	ParseFen(Game *Gm, char *fen)									// scans fen string and sets all var
    {(Gm->Moves[0]).ep=i; (Gm->Moves[0]).HASH^=RANDOM_P[i&7];}			// update position hash with ep
  }
  else (Gm->Moves[0]).ep=0;												// no ep
+#if defined(USE_ATTACKS)
+ InitAttacks(Gm);														// compute attack tables
+#endif
 }
 
 void 	InitDataStructures()											// initializes data structures
 {
- int r;
+ const signed char DR[8]={-1,-1,-1,0,0,1,1,1},DF[8]={-1,0,1,-1,1,-1,0,1};	// ray directions (rank, file)
+ int r,d,n,x,y;
+ Byte S[8];
+ BitMap BM;
 
  HEN = (BitMap)(Paras[0].Val*0x100000)/32; 								// number of transposition table entries
- PEN = (BitMap)(Paras[1].Val*0x100000)/40;								// number of pawn table entries
- MEN = (BitMap)(Paras[2].Val*0x100000)/8;								// number of material table entries
+ PEN = (BitMap)(Paras[1].Val*0x100000)/64;								// number of pawn table buckets
  EEN = (BitMap)(Paras[3].Val*0x100000)/8;								// number of evaluation table entries
- DEN = (BitMap)(Paras[0].Val*0x100000)/16; 								// number of perft/divide table entries)
+ DEN = (BitMap)(Paras[108].Val*0x100000)/64; 							// number of perft table buckets
 
  hash_t =(Byte*)(malloc(Paras[0].Val*0x100000+32));						// allocate memory for transposition table
- phash_t=(Byte*)(malloc(Paras[1].Val*0x100000+40));						// allocate memory for pawn hash table
- mhash_t=(Byte*)(malloc(Paras[2].Val*0x100000+8));						// allocate memory for material hash table
- ehash_t=(Byte*)(malloc(Paras[3].Val*0x100000+8));						// allocate memory for evaluation hash table
+ phash_t=AllocTable(Paras[1].Val);										// allocate memory for pawn hash table
+ mat_t=(Mat*)(malloc(MATN*sizeof(Mat)));								// allocate memory for material table
+ ehash_t=AllocTable(Paras[3].Val);										// allocate memory for evaluation hash table
+ perft_t=AllocTable(Paras[108].Val);									// allocate memory for perft hash table
 
+ for(r=0;r<64;r++) for(d=0;d<8;d++)										// squares behind squares on the rays of r
+ {
+  n=0; y=r/8+DR[d]; x=r%8+DF[d];										// first square of ray
+  for(;(Byte)(y)<8&&(Byte)(x)<8;y+=DR[d],x+=DF[d]) S[n++]=8*y+x;		// squares of ray
+  for(BM=0;n;n--) {XRAY[r][S[n-1]]=BM; BM|=A8<<S[n-1];}					// squares behind each square of ray
+ }
+ 
  for(r=0;r<1024;r++) recog[r]=NoRecog;									// initialize recognizer function pointers
  
  // material signature: white Q=001,R=002,B=004,N=008,P=010  black Q=020,R=040,B=080,N=100,P=200
@@ -1557,6 +2675,84 @@ void 	InitDataStructures()											// initializes data structures
  recog[0x104]=KBvKN;  recog[0x088]=KNvKB;
  // recog[0x202]=KRvKP;  recog[0x050]=KPvKR;
  recog[0x052]=KRPvKR; recog[0x242]=KRvKRP;
+ 
+ InitMaterial();														// material table needs recognizers
+}
+
+void	InitMaterial()													// fill direct-indexed material table
+{
+ static short	P[11]={-1};												// material parameters of the table
+ Byte	N[2][6],c,i,p;
+ Fbyte	k,r,W[6];
+
+ for(c=i=0;i<11;i++) if(P[i]!=PAR(i<6?5+i:95+i)) {P[i]=PAR(i<6?5+i:95+i); c=1;}
+ if(!c) return;															// table is up to date
+ for(W[5]=1,i=5;i;i--) W[i-1]=W[i]*(MatCap[i]+1);						// key weights of one side
+ for(c=0;c<2;c++)
+ {
+  r=c?W[0]*(MatCap[0]+1):1;												// black digits above white ones
+  MatW[c][1][0]=MatW[c][1][1]=0;										// king
+  MatW[c][2][0]=MatW[c][2][1]=W[0]*r; MatW[c][3][0]=MatW[c][3][1]=W[1]*r;	// queen, rook
+  MatW[c][4][1]=W[2]*r; MatW[c][4][0]=W[3]*r;							// bishop on light or dark square
+  MatW[c][5][0]=MatW[c][5][1]=W[4]*r; MatW[c][6][0]=MatW[c][6][1]=W[5]*r;	// knight, pawn
+ }
+ for(k=0;k<MATN;k++)													// all piece counts in range
+ {
+  for(r=k,p=c=0;c<2;c++)												// decode key
+  {
+   for(i=6;i;i--) {N[c][i-1]=r%(MatCap[i-1]+1); r/=MatCap[i-1]+1;}
+   p+=4*N[c][0]+2*N[c][1]+N[c][2]+N[c][3]+N[c][4];						// game phase (q=4,r=2,b,n=1)
+  }
+  MatEntry(N,p,mat_t+k);
+ }
+}
+
+void	MatEntry(Byte N[2][6], Byte p, Mat* M)							// material entry of counts Q,R,B(light),B(dark),N,P
+{
+ short	Pa,Pc[2],Val,v[5];
+ Byte	c,i,b,j;
+ Dbyte	sig=0;
+
+ p=min(p,24);
+ for(i=0;i<5;i++) v[i]=(p*PAR(5+i)+(24-p)*PAR(101+i))/48;				// calculate material values dependent on game phase
+ for(c=0;c<2;c++)
+ {
+  Pc[c]=N[c][0]*v[0]+N[c][1]*v[1]+(N[c][2]+N[c][3])*v[2]+N[c][4]*v[3];	// accumulate piece values
+  for(i=0;i<5;i++) if(i<2?N[c][i]:(i==2?N[c][2]+N[c][3]:N[c][i+1]))
+   sig|=1<<(5*c+i);														// material signature
+ }
+
+ Val=Pc[0]-Pc[1]+(short)(N[0][5]-N[1][5])*v[4];							// add pawn values
+
+ if(N[0][2]&&N[0][3]) Val+=PAR(10);										// pair of bishops bonus white
+ if(N[1][2]&&N[1][3]) Val-=PAR(10);										// pair of bishops bonus black
+ b=(N[0][2]+N[0][3]<2)&&(N[1][2]+N[1][3]<2)&&
+   (N[0][2]+N[1][2])&&(N[0][3]+N[1][3]);								// single differently colored bishops
+
+ Pa=v[4]*((short)N[0][5]-5); if(Pa<0) Pa=0;								// value of number of pawns above 5 for white
+ Val+=N[0][4]*(Pa/16)-N[0][1]*(Pa/8);									// bonus for knights, malus for rooks with pawns on the board
+ Pa=v[4]*((short)N[1][5]-5); if(Pa<0) Pa=0;								// value of number of pawns above 5 for black
+ Val-=N[1][4]*(Pa/16)-N[1][1]*(Pa/8);									// bonus for knights, malus for rooks with pawns on the board
+
+ j=64;
+ if(Val)
+ {
+  c=Val<0;																// leading side
+  if((!N[c][5])&&(Pc[c]-Pc[1-c]<=v[2]))									// no pawns and less than a bishop ahead
+   j=(Pc[c]<v[1]) ? 0 : ((Pc[1-c]<=v[2]) ? 4 : 14);						// scale factor for reduced material
+  else if(b&&(N[0][0]+N[0][1]+N[0][2]+N[0][3]+N[0][4]==1)&&
+  			 (N[1][0]+N[1][1]+N[1][2]+N[1][3]+N[1][4]==1)) j=22;		// opposing bishops
+  else j=min(64,36+(b?2:7)*N[c][5]);									// scale factor for reduced material
+ }
+
+ M->Val=(Val*(short)(j))/64; M->Scale=j;								// scaling the material value
+ M->Rec=(recog[sig]!=NoRecog);											// recognizer for this material
+}
+
+Byte	MatExcess(BitMap PM, Byte p, Byte s)							// piece of type p on s exceeds material table range?
+{
+ if(p==4) PM&=((WS>>s)&1)?WS:BS;										// bishops of the same square color
+ return Popcount(PM)>((p==3)||(p==5)?2:1);
 }
 
 short 	NoRecog(Game* Gm, Byte *flags)									// No recognizer available
@@ -1565,23 +2761,78 @@ short 	NoRecog(Game* Gm, Byte *flags)									// No recognizer available
  return 0;
 }
 
+#if 		defined(USE_AVX2)
+#define SHIFTV(x,l,r)	_mm256_or_si256(_mm256_sllv_epi64(x,l),_mm256_srlv_epi64(x,r))
+#define KSTEP(g,p,l,r)	g=_mm256_or_si256(g,_mm256_and_si256(p,SHIFTV(g,l,r)))
+#define LANEOR(x)		_mm256_or_si256(x,_mm256_shuffle_epi32(x,0x4E))
+
+void	SliderAttacks(Game* Gm, Byte c, BitMap* ATK, BitMap* OATK)		// attacks of all sliders of color c at once
+{
+ // lanes: orthogonal N,S,E,W and diagonal NE,SW,NW,SE (a8=bit 0), variable shifts >=64 give 0
+ const __m256i	L1=_mm256_setr_epi64x(64,8,1,64),  R1=_mm256_setr_epi64x(8,64,64,1);	// orthogonal steps 1,2,4
+ const __m256i	L2=_mm256_setr_epi64x(64,16,2,64), R2=_mm256_setr_epi64x(16,64,64,2);
+ const __m256i	L4=_mm256_setr_epi64x(64,32,4,64), R4=_mm256_setr_epi64x(32,64,64,4);
+ const __m256i	D1=_mm256_setr_epi64x(64,7,64,9),  E1=_mm256_setr_epi64x(7,64,9,64);	// diagonal steps 1,2,4
+ const __m256i	D2=_mm256_setr_epi64x(64,14,64,18),E2=_mm256_setr_epi64x(14,64,18,64);
+ const __m256i	D4=_mm256_setr_epi64x(64,28,64,36),E4=_mm256_setr_epi64x(28,64,36,64);
+ const __m256i	MO=_mm256_setr_epi64x(-1,-1,PA,PH),MD=_mm256_setr_epi64x(PA,PH,PH,PA);	// no wraps to a- or h-file
+ __m256i		EM,PO,PD,RO,QO,BD,QD;
+
+ EM=_mm256_set1_epi64x(~Gm->ROTATED[0]);								// empty squares
+ PO=_mm256_and_si256(EM,MO); PD=_mm256_and_si256(EM,MD);				// propagators
+ RO=_mm256_set1_epi64x(Gm->POSITION[c][3]); BD=_mm256_set1_epi64x(Gm->POSITION[c][4]);	// rooks and bishops
+ QO=QD=_mm256_set1_epi64x(Gm->POSITION[c][2]);							// queens
+
+ KSTEP(RO,PO,L1,R1); KSTEP(QO,PO,L1,R1); KSTEP(BD,PD,D1,E1); KSTEP(QD,PD,D1,E1);	// Kogge-Stone occluded fills
+ PO=_mm256_and_si256(PO,SHIFTV(PO,L1,R1)); PD=_mm256_and_si256(PD,SHIFTV(PD,D1,E1));
+ KSTEP(RO,PO,L2,R2); KSTEP(QO,PO,L2,R2); KSTEP(BD,PD,D2,E2); KSTEP(QD,PD,D2,E2);
+ PO=_mm256_and_si256(PO,SHIFTV(PO,L2,R2)); PD=_mm256_and_si256(PD,SHIFTV(PD,D2,E2));
+ KSTEP(RO,PO,L4,R4); KSTEP(QO,PO,L4,R4); KSTEP(BD,PD,D4,E4); KSTEP(QD,PD,D4,E4);
+ RO=_mm256_and_si256(SHIFTV(RO,L1,R1),MO); QO=_mm256_and_si256(SHIFTV(QO,L1,R1),MO);	// one more step gives attacks
+ BD=_mm256_and_si256(SHIFTV(BD,D1,E1),MD); QD=_mm256_and_si256(SHIFTV(QD,D1,E1),MD);
+
+ RO=LANEOR(RO); QO=LANEOR(QO); BD=LANEOR(BD); QD=LANEOR(QD);			// join opposite directions
+ EM=_mm256_or_si256(RO,QO); ATK[1]|=_mm256_extract_epi64(EM,0); ATK[0]|=_mm256_extract_epi64(EM,2);	// vertical and horizontal attacks
+ EM=_mm256_or_si256(BD,QD); ATK[2]|=_mm256_extract_epi64(EM,0); ATK[3]|=_mm256_extract_epi64(EM,2);	// diagonal 1 (a1-h8) and 2 (a8-h1) attacks
+ OATK[2]|=_mm256_extract_epi64(QO,0)|_mm256_extract_epi64(QO,2)|
+ 		  _mm256_extract_epi64(QD,0)|_mm256_extract_epi64(QD,2);		// queen attacks
+ OATK[3]|=_mm256_extract_epi64(RO,0)|_mm256_extract_epi64(RO,2);		// rook attacks
+ OATK[4]|=_mm256_extract_epi64(BD,0)|_mm256_extract_epi64(BD,2);		// bishop attacks
+}
+#endif
+
+#if defined(USE_ATTACKS)
+#define LINEATK(s,j)	(Gm->ATKF[s]&SLIDE[s][j][0])					// attacks of slider on line j from attack table
+#else
+#define LINEATK(s,j)	SLIDE[s][j][Gm->ROTATED[j]>>shift[j][s]&255]	// attacks of slider on line j
+#endif
+
 void 	GenMoves(Game *Gm, Mvs *Mv)										// generate moves as bitmaps
 {
- Byte i,c,s,t,cm,cas,ep;
+ Byte i,j,c,s,t,cm,cas,ep,sa=false;
  BitMap B0,B1,B2,B3,BA,BC,BE1,BE2,BK,BM,BN,BP,ATK[8],K;
  
  for(i=0;i<6;i++) 	Mv->OATK[i]=0;										// initialize opponent attacks
  for(i=0;i<8;i++) 	{ATK[i]=0; Mv->Prop[i]=0;}							// hor., vert. and diag. attacks, promotion info
  
  c=Gm->color; BK=Gm->POSITION[c][1]; BA=BC=0; cm=0;						// stm color and king position bitmap
+ Mv->sn=0;																// empty SEE cache
  cas=(Gm->Moves[Gm->Move_n]).castles; ep=(Gm->Moves[Gm->Move_n]).ep;	// castles and ep
+#if 		defined(USE_AVX2)
+ if((sa=Options[10].Val)) SliderAttacks(Gm,1-c,ATK,Mv->OATK);			// opposing sliders set-wise
+#endif
  
  for(i=0;i<(Gm->Count[1-c]).officers;i++)								// walk thru opposing officers
  {
   s=(Gm->Officer[1-c][i]).square; t=(Gm->Officer[1-c][i]).type;			// piece position and type
+  if(sa&&(t>1)&&(t<5)) continue;										// slider done set-wise
+#if defined(USE_ATTACKS)
+  BM=Gm->ATKF[s];														// attacks from table
+  if((t>1)&&(t<5)) for(j=0;j<4;j++) ATK[j]|=BM&SLIDE[s][j][0];			// split slider attacks into lines
+#else
   switch(t)																// parse type
   {
-   case 1: BM=STEP[1][s]; break;										// king	
+   case 1: BM=STEP[1][s]; break;										// king
    case 2: BM=SLIDE[s][0][Gm->ROTATED[0]>>shift[0][s]&255]; 
    		   ATK[0]|=BM; 													// queen horizontal attacks
    	       BN=SLIDE[s][1][Gm->ROTATED[1]>>shift[1][s]&255];
@@ -1601,11 +2852,22 @@ void 	GenMoves(Game *Gm, Mvs *Mv)										// generate moves as bitmaps
 		   BN=SLIDE[s][3][Gm->ROTATED[3]>>shift[3][s]&255];
 		   ATK[3]|=BN; BM|=BN; 											// bishop diagonal 2 attacks
 		   break;
-   case 5: BM=STEP[2][s]; break;										// knight 		   
+   case 5: BM=STEP[2][s]; break;										// knight
   }
+#endif
   Mv->OATK[t]|=BM; BA|=BM;												// all attacks of types, all attacks
   if(BM&BK) {cm+=64; BC|=A8<<s;}										// increase check count, store checker
  }
+ if(sa)																	// set-wise slider attacks
+ {
+  BA|=Mv->OATK[2]|Mv->OATK[3]|Mv->OATK[4]; t=(Gm->Officer[c][0]).square;	// all attacks, stm king pos
+  for(j=0;j<4;j++) if(ATK[j]&BK)										// king attacked on this line
+  {
+   K=SLIDE[t][j][Gm->ROTATED[j]>>shift[j][t]&255]&						// checking sliders
+     (Gm->POSITION[1-c][2]|Gm->POSITION[1-c][j<2?3:4]);
+   for(BC|=K;K;K&=K-1) cm+=64;											// increase check count, store checkers
+  }
+ }
  BP=Gm->POSITION[1-c][6]; BM=PA&BP; BN=PH&BP;							// opponent's pawns positions
  if(c) {BM>>=9; BN>>=7;} else {BM<<=7; BN<<=9;}							// opponent's pawns attacks
  Mv->OATK[0]=(BA|=BM|BN); s=(Gm->Officer[c][0]).square;					// register all attacks, stm king pos
@@ -1641,44 +2903,44 @@ void 	GenMoves(Game *Gm, Mvs *Mv)										// generate moves as bitmaps
   {
    case 2: if(!(B0&BK))													// not pinned
    		   {
-			BN=SLIDE[s][0][Gm->ROTATED[0]>>shift[0][s]&255];			// queen horizontal
+			BN=LINEATK(s,0);											// queen horizontal
 			ATK[4]|=BN; BM|=BN;
 		   }
 		   if(!(B1&BK))													// not pinned
    		   {
-			BN=SLIDE[s][1][Gm->ROTATED[1]>>shift[1][s]&255];			// queen vertical
+			BN=LINEATK(s,1);											// queen vertical
 			ATK[5]|=BN; BM|=BN;
 		   }
 		   if(!(B2&BK))													// not pinned
    		   {
-			BN=SLIDE[s][2][Gm->ROTATED[2]>>shift[2][s]&255];			// queen diagonal 1
+			BN=LINEATK(s,2);											// queen diagonal 1
 			ATK[6]|=BN; BM|=BN;
 		   }
 		   if(!(B3&BK))													// not pinned
    		   {
-			BN=SLIDE[s][3][Gm->ROTATED[3]>>shift[3][s]&255];			// queen diagonal 2
+			BN=LINEATK(s,3);											// queen diagonal 2
 			ATK[7]|=BN; BM|=BN;
 		   }
 		   break;									
    case 3: if(!(B0&BK))													// not pinned
  		   {
-			BN=SLIDE[s][0][Gm->ROTATED[0]>>shift[0][s]&255];			// rook horizontal
+			BN=LINEATK(s,0);											// rook horizontal
 			ATK[4]|=BN; BM|=BN;
 		   }
 		   if(!(B1&BK))													// not pinned
    		   {
-			BN=SLIDE[s][1][Gm->ROTATED[1]>>shift[1][s]&255];			// rook vertical
+			BN=LINEATK(s,1);											// rook vertical
 			ATK[5]|=BN; BM|=BN;
 		   }
 		   break;
    case 4: if(!(B2&BK))													// not pinned
    		   {
-			BN=SLIDE[s][2][Gm->ROTATED[2]>>shift[2][s]&255];			// bishop diagonal 1
+			BN=LINEATK(s,2);											// bishop diagonal 1
 			ATK[6]|=BN; BM|=BN;
 		   }
 		   if(!(B3&BK))													// not pinned
    		   {
-			BN=SLIDE[s][3][Gm->ROTATED[3]>>shift[3][s]&255];			// bishop diagonal 2
+			BN=LINEATK(s,3);											// bishop diagonal 2
 			ATK[7]|=BN; BM|=BN;
 		   }
 		   break;
@@ -1761,7 +3023,7 @@ Dbyte 	PickMove(Game *Gm, Mvs *Mv)										// picks next move from movelist
   Fr=(Gm->Officer[Gm->color][Mv->o-1]).square;							// origin
   To=(find_b[(BM^BM-1)%67]<<8)+Fr;										// destination, build move												
   if((Mv->flg&2)&&(Mv->OATK[0]&BM)) 									// move has no fitting SEE
-   {Mv->CMB^=BM; if(!SEE(Gm,To,(short)(Mv->flg&1))) continue;}			// clear move from current bitmap
+   {Mv->CMB^=BM; if(!SEE(Gm,Mv,To,(short)(Mv->flg&1))) continue;}		// clear move from current bitmap
   Mv->OFFM[Mv->o-1]^=BM; return(To);									// clear move from database and deliver										
  }
  
@@ -1881,7 +3143,7 @@ Dbyte 	PickMove(Game *Gm, Mvs *Mv)										// picks next move from movelist
   case 35:  if(BM=Mv->PAWM[i=2])					goto PMove; break;	// unsorted: pawn capture left
   case 36:  if(BM=Mv->PAWM[i=0])					goto PMove; break;	// unsorted: pawn capture right
   case 37:	Mv->s+=1; Mv->hist=0;
-			if((!Gm->Move_n)||(Gm->Move_n-Gm->Move_r>Paras[97].Val)||
+			if((!Gm->Move_n)||(Gm->Move_n-Gm->Move_r>PAR(97))||
 			   (!(Gm->Moves[Gm->Move_n-1].Mov))) 				break;	// History moves
   case 38:  p=(Gm->Moves[Gm->Move_n-1]).type-1; Mv->flg&=~2;			// last move's piece type
 			q=(Gm->Moves[Gm->Move_n-1]).to&63; BN=0; t=6;				// last move's destination
@@ -1914,7 +3176,7 @@ Dbyte 	PickMove(Game *Gm, Mvs *Mv)										// picks next move from movelist
 			 }
 		    }
 			if(!BN)											return(0);	// no more moves left
-			if((BN==1)||(++(Mv->hist)>Paras[96].Val)) 			break;	// no history score
+			if((BN==1)||(++(Mv->hist)>PAR(96))) 			break;		// no history score
 			if(t==6) {if(i==1) goto PMove; else 	goto DMove;}		// make best pawn move
 			Mv->o=i; 									goto NMoveO;	// make best officer move																			    
   case 39:  Mv->CMB=PST[Gm->color][Gm->phase<16?1:0][5][0]&				// prepare pawn double step to save squares...
@@ -2117,7 +3379,7 @@ Dbyte 	PickMove(Game *Gm, Mvs *Mv)										// picks next move from movelist
  DMoveS:																// pawn double step SEE save
   BM=Mv->CMB; To=find_b[(BM^BM-1)%67]; Fr=To+16-32*Gm->color; Mv->o=0;	// from and to square
   Mv->CMB&=Mv->CMB-1; Fr+=(To<<8);  									// clear move
-  if(SEE(Gm,Fr,0)) {BM&=-BM; (Mv->PAWM[3])^=BM; return Fr;} goto NMoveP;// deliver move if save
+  if(SEE(Gm,Mv,Fr,0)) {BM&=-BM; (Mv->PAWM[3])^=BM; return Fr;} goto NMoveP;// deliver move if save
    
  PMove:																	// pawn regular move
   BM&=-BM; To=find_b[(BM^BM-1)%67]; Fr=To+9-i-16*Gm->color; Mv->o=0;	// isolate move, from and to square			
@@ -2136,7 +3398,7 @@ Dbyte 	PickMove(Game *Gm, Mvs *Mv)										// picks next move from movelist
  PMoveS:																// pawn single step SEE save
   BM=Mv->CMB; To=find_b[(BM^BM-1)%67]; Fr=To+8-16*Gm->color; Mv->o=0;	// from and to square
   Mv->CMB&=(Mv->CMB)-1; Fr+=(To<<8);									// clear move
-  if(SEE(Gm,Fr,0)) {BM&=-BM; (Mv->PAWM[1])^=BM; return Fr;} goto NMoveP;// deliver move if save
+  if(SEE(Gm,Mv,Fr,0)) {BM&=-BM; (Mv->PAWM[1])^=BM; return Fr;} goto NMoveP;// deliver move if save
   
  SMove:																	// predefined move
   Mv->o=0; Mv->flg&=~2; Fr=Hm&63;										// initialize move search
@@ -2203,12 +3465,13 @@ void 	UncodeMove(Dbyte Mv, char *Mo)									// translates move to string
 void 	Move(Game* Gm, Dbyte Mv)										// makes move
 {
  Byte 	i,j,c,cas,ep,fi,f,t,cs,p,o,s,pc,oc;
- BitMap	HB,TB,FB,BS;
+ BitMap	HB,TB,FB,BS,OCC,CH;
  
  c=Gm->color; HB=(Gm->Moves[Gm->Move_n]).HASH;							// stm color and hash
  cas=(Gm->Moves[Gm->Move_n]).castles; ep=(Gm->Moves[Gm->Move_n]).ep;	// castles and ep
  fi=Gm->Moves[Gm->Move_n].fifty;										// fifty move counter
  cs=t=(Byte)(Mv>>8)&63; f=(Byte)(Mv&63);								// destination and origin
+ OCC=Gm->ROTATED[0]; CH=(f==t)?0:A8<<t;								// old occupancy and destination for attack update
  (Gm->Moves[Gm->Move_n]).from=f; (Gm->Moves[Gm->Move_n]).to=t;			// register move in move list
  if(Mv&64)  (Gm->Moves[Gm->Move_n]).check=true;							// set check info
  else		(Gm->Moves[Gm->Move_n]).check=false;
@@ -2250,10 +3513,11 @@ void 	Move(Game* Gm, Dbyte Mv)										// makes move
   (Gm->Moves[Gm->Move_n-1]).cap=(oc<<4)+pc;								// index and type of captured piece
   if(cs!=t)	(Gm->Moves[Gm->Move_n-1]).cap|=8;							// ep		
   (Gm->Piece[1-c][cs]).type=(Gm->Piece[1-c][cs]).index=0;				// remove piece from board	
+  if((pc<6)&&MatExcess(Gm->POSITION[1-c][pc],pc,cs)) (Gm->Mexc)--;		// captured piece was beyond table range
   Gm->POSITION[1-c][0]-=(A8<<cs); Gm->POSITION[1-c][pc]-=(A8<<cs); 		// remove piece from type-bitmaps							
   if(!Gm->POSITION[1-c][pc]) Gm->Matsig&=~(0x001<<(5-5*c+pc-2));		// no piece of this type left? remove from matsig	
   HB^=RANDOM_B[1-c][pc-1][cs];											// update position hash
-  Gm->MHASH-=RANDOM_B[1-c][pc-1][0];									// update material hash
+  Gm->MKEY-=MatW[1-c][pc][(WS>>cs)&1];									// update material key
   (Gm->Psv[1-c]).Open-=Square[1-c][pc-1][0][cs];						// piece square value opening
   (Gm->Psv[1-c]).End -=Square[1-c][pc-1][1][cs];						// piece square value endgame													
   fi=0;																	// reset fifty move counter 													
@@ -2285,6 +3549,7 @@ void 	Move(Game* Gm, Dbyte Mv)										// makes move
    if(p==2) Gm->phase+=4; else if(p==3) Gm->phase+=2; else (Gm->phase)++;// update game phase
    ((Gm->Count[c]).pawns)--; i=((Gm->Count[c]).officers)++;				// dec. pawn, inc. officer
    Gm->POSITION[c][6]-=TB; Gm->POSITION[c][p]|=TB;						// remove pawn, set officer		
+   if(MatExcess(Gm->POSITION[c][p],p,t)) (Gm->Mexc)++;					// new piece beyond table range
    if(!Gm->POSITION[c][6]) Gm->Matsig&=~(0x001<<(4+5*c));				// no pawn left? remove from matsig		
    (Gm->Piece[c][t]).type=p; 	(Gm->Piece[c][t]).index=i;				// type and index of new piece
    (Gm->Officer[c][i]).type=p;	(Gm->Officer[c][i]).square=t;			// type and square of new piece
@@ -2292,9 +3557,8 @@ void 	Move(Game* Gm, Dbyte Mv)										// makes move
    (Gm->Psv[c]).End +=Square[c][p-1][1][t]-Square[c][5][1][t];			// piece square value endgame
    HB^=RANDOM_B[c][5][t];												// remove pawn from position hash
    Gm->PHASH^=RANDOM_B[c][5][t];										// remove pawn from pawn evaluation hash
-   Gm->MHASH-=RANDOM_B[c][5][0];										// remove pawn from material hash
+   Gm->MKEY+=MatW[c][p][(WS>>t)&1]-MatW[c][6][0];						// replace pawn in material key
    HB^=RANDOM_B[c][p-1][t];												// set new piece in position hash
-   Gm->MHASH+=RANDOM_B[c][p-1][0];										// set new piece in material hash
   }
   fi=0;																	// reset fifty move counter	
  }
@@ -2327,21 +3591,26 @@ void 	Move(Game* Gm, Dbyte Mv)										// makes move
   }
  }
  Finish:
+ __builtin_prefetch(ehash_t+(HB%EEN)*8);								// evaluation entry of new position
  (Gm->Moves[Gm->Move_n]).HASH=HB; 	  (Gm->Moves[Gm->Move_n]).fifty=fi;	// store data of position after move
  (Gm->Moves[Gm->Move_n]).castles=cas; (Gm->Moves[Gm->Move_n]).ep=ep;
+#if defined(USE_ATTACKS)
+ if(CH) UpdateAttacks(Gm,CH|(OCC^Gm->ROTATED[0]));						// update attacks along changed squares
+#endif
  return;
 }
 
 void 	UnMove(Game* Gm)												// takes back move
 {
  Byte 	c,i,j,k,f,t,s,p,o,pc;
- BitMap	CB,FB,TB;
+ BitMap	CB,FB,TB,OCC,CH;
  
  c=1-Gm->color; Gm->color=c; (Gm->Move_n)--; 							// restore color and move number
  f=(Gm->Moves[Gm->Move_n]).from;  										// get origin
  t=(Gm->Moves[Gm->Move_n]).to;											// get destination
  if(f==t) return;														// nullmove
  FB=A8<<f; TB=A8<<t;													// from and to bitmaps
+ OCC=Gm->ROTATED[0]; CH=TB;												// occupancy and destination for attack update
  p=(Gm->Piece[c][t]).type; o=(Gm->Piece[c][t]).index;					// type and index of piece
  (Gm->Psv[c]).Open+=Square[c][p-1][0][f]-Square[c][p-1][0][t];			// piece square value opening
  (Gm->Psv[c]).End +=Square[c][p-1][1][f]-Square[c][p-1][1][t];			// piece square value endgame
@@ -2352,13 +3621,13 @@ void 	UnMove(Game* Gm)												// takes back move
   (Gm->Psv[c]).End +=Square[c][5][1][f]-Square[c][p-1][1][f];			// piece square value endgame
   if(p==2) Gm->phase-=4; else if(p==3) Gm->phase-=2; else (Gm->phase)--;// update game phase
   ((Gm->Count[c]).pawns)++; j=--((Gm->Count[c]).officers);				// inc. pawn, dec. officer
+  if(MatExcess(Gm->POSITION[c][p],p,t)) (Gm->Mexc)--;					// promoted piece was beyond table range
   Gm->POSITION[c][6]|=TB; Gm->POSITION[c][p]-=TB;						// set pawn, remove officer
   if(!Gm->POSITION[c][p]) Gm->Matsig&=~(0x001<<(5*c+p-2));				// last piece of this type? remove from matsig
   (Gm->Piece[c][t]).type=6; (Gm->Piece[c][t]).index=0;					// set type as pawn (no index)
   (Gm->Officer[c][j]).type=(Gm->Officer[c][j]).square=0;				// remove officer
   Gm->PHASH^=RANDOM_B[c][5][t];											// introduce pawn in pawn evaluation hash
-  Gm->MHASH+=RANDOM_B[c][5][0];											// introduce pawn in material hash
-  Gm->MHASH-=RANDOM_B[c][p-1][0];										// subtract piece from material hash							
+  Gm->MKEY+=MatW[c][6][0]-MatW[c][p][(WS>>t)&1];						// replace piece by pawn in material key
   p=6;	o=0;															// moving piece type is pawn
  }
  (Gm->Piece[c][f]).type=p; (Gm->Piece[c][f]).index=o;					// set piece on origin square
@@ -2387,7 +3656,8 @@ void 	UnMove(Game* Gm)												// takes back move
   Gm->Matsig|=(0x001<<(3+pc-5*c));										// set piece in material signature
   (Gm->Psv[1-c]).Open+=Square[1-c][pc-1][0][i];							// piece square value opening
   (Gm->Psv[1-c]).End +=Square[1-c][pc-1][1][i];							// piece square value endgame
-  Gm->MHASH+=RANDOM_B[1-c][pc-1][0];									// add piece to material hash
+  Gm->MKEY+=MatW[1-c][pc][(WS>>i)&1];									// add piece to material key
+  if((pc<6)&&MatExcess(Gm->POSITION[1-c][pc],pc,i)) (Gm->Mexc)++;		// restored piece beyond table range
   if(pc==6) 															// increase pawn counter
    {((Gm->Count[1-c]).pawns)++; Gm->PHASH^=RANDOM_B[1-c][5][i];}		// increase pawn counter and create pawn...	
   else																	// ...in pawn evaluation hash		
@@ -2409,28 +3679,107 @@ void 	UnMove(Game* Gm)												// takes back move
   for(j=1;j<4;j++)														// remove piece in rotated bitmaps
    {s=shift[j+3][t]; Gm->ROTATED[j]-=s<128?TB<<s:TB>>(256-s);}
  }
- if((p==1)&&((t-f==2)||(f-t==2)))										// castles
+ if((p==1)&&((t-f==2)||(f-t==2)))										// castles
+ {
+  if(t-f==2) {f+=3; t--;}							 					// castles kingside
+  else {f-=4; t++;}														// castles queenside
+  FB=(A8<<f); TB=(A8<<t);												// bitmaps of move
+  (Gm->Piece[c][f]).type=3;												// move rook to origin square
+  j=(Gm->Piece[c][f]).index=(Gm->Piece[c][t]).index;					// move index to origin
+  (Gm->Piece[c][t]).type=(Gm->Piece[c][t]).index=0;						// clear rook from destination square
+  (Gm->Officer[c][j]).square=f;											// set rook origin square
+  (Gm->Psv[c]).Open+=Square[c][2][0][f]-Square[c][2][0][t];				// piece square value opening
+  (Gm->Psv[c]).End +=Square[c][2][1][f]-Square[c][2][1][t];				// piece square value endgame				
+  Gm->POSITION[c][0]^=TB|FB;	Gm->POSITION[c][3]^=TB|FB;				// move rook in type-bitmaps					
+  Gm->ROTATED[0]-=TB; Gm->ROTATED[0]|=FB;								// move rook in general bitmaps 							
+  for(j=1;j<4;j++)														// move rook in rotated bitmaps
+  {
+   s=shift[j+3][t]; Gm->ROTATED[j]-=s<128?TB<<s:TB>>(256-s);
+   s=shift[j+3][f]; Gm->ROTATED[j]|=s<128?FB<<s:FB>>(256-s);  
+  }
+ }
+#if defined(USE_ATTACKS)
+ UpdateAttacks(Gm,CH|(OCC^Gm->ROTATED[0]));								// update attacks along changed squares
+#endif
+ return;
+}
+
+BitMap	PieceAttacks(Game* Gm, Byte c, Byte t, Byte s)					// attacks of piece type t of color c from square s
+{
+ BitMap BM=0;
+
+ switch(t)																// switch piece type
+ {
+  case 1: return STEP[1][s];											// king
+  case 2: BM=SLIDE[s][2][Gm->ROTATED[2]>>shift[2][s]&255]|				// queen diagonals
+  			 SLIDE[s][3][Gm->ROTATED[3]>>shift[3][s]&255];
+  case 3: return BM|SLIDE[s][0][Gm->ROTATED[0]>>shift[0][s]&255]|		// rook or queen horizontal and vertical
+  			 		SLIDE[s][1][Gm->ROTATED[1]>>shift[1][s]&255];
+  case 4: return SLIDE[s][2][Gm->ROTATED[2]>>shift[2][s]&255]|			// bishop diagonals
+  			 	 SLIDE[s][3][Gm->ROTATED[3]>>shift[3][s]&255];
+  case 5: return STEP[2][s];											// knight
+  case 6: return STEP[3+c][s];											// pawn captures
+ }
+ return 0;																// empty square
+}
+
+BitMap	AttacksTo(Game* Gm, Byte c, Byte k)								// pieces of color c attacking square k
+{
+ BitMap BM;
+#if defined(USE_ATTACKS)
+ Byte	i,s;
+
+ BM=STEP[4-c][k]&Gm->POSITION[c][6];									// pawns
+ for(i=0;i<(Gm->Count[c]).officers;i++)									// officers from attack table
+  if(Gm->ATKF[s=(Gm->Officer[c][i]).square]&(A8<<k)) BM|=A8<<s;
+ return BM;
+#endif
+
+ BM =STEP[1][k]&Gm->POSITION[c][1];										// king
+ BM|=STEP[2][k]&Gm->POSITION[c][5];										// knights
+ BM|=STEP[4-c][k]&Gm->POSITION[c][6];									// pawns
+ BM|=(SLIDE[k][0][Gm->ROTATED[0]>>shift[0][k]&255]|						// queens and rooks
+ 	  SLIDE[k][1][Gm->ROTATED[1]>>shift[1][k]&255])&(Gm->POSITION[c][2]|Gm->POSITION[c][3]);
+ BM|=(SLIDE[k][2][Gm->ROTATED[2]>>shift[2][k]&255]|						// queens and bishops
+ 	  SLIDE[k][3][Gm->ROTATED[3]>>shift[3][k]&255])&(Gm->POSITION[c][2]|Gm->POSITION[c][4]);
+ return BM;
+}
+
+#if defined(USE_ATTACKS)
+
+void	InitAttacks(Game* Gm)											// compute attack tables from scratch
+{
+ Byte	s;
+
+ for(s=0;s<64;s++) Gm->ATKF[s]=0;										// clear table
+ UpdateAttacks(Gm,Gm->ROTATED[0]);										// all occupied squares
+}
+
+void	UpdateAttacks(Game* Gm, BitMap CH)								// update attack tables after squares CH changed
+{
+ BitMap	BM,QR,QB,SM=CH;
+ Byte	x,c;
+
+ QR=Gm->POSITION[0][2]|Gm->POSITION[1][2]|Gm->POSITION[0][3]|Gm->POSITION[1][3];// queens and rooks
+ QB=Gm->POSITION[0][2]|Gm->POSITION[1][2]|Gm->POSITION[0][4]|Gm->POSITION[1][4];// queens and bishops
+ BM=CH; while(BM)														// parse changed squares
+ {
+  x=find_b[(BM^BM-1)%67]; BM&=BM-1;										// changed square
+  SM|=(SLIDE[x][0][Gm->ROTATED[0]>>shift[0][x]&255]|					// sliders seeing the square: visibility does
+  	   SLIDE[x][1][Gm->ROTATED[1]>>shift[1][x]&255])&QR;				// not depend on the square's own occupancy
+  SM|=(SLIDE[x][2][Gm->ROTATED[2]>>shift[2][x]&255]|
+  	   SLIDE[x][3][Gm->ROTATED[3]>>shift[3][x]&255])&QB;
+ }
+ while(SM)																// recompute affected pieces
  {
-  if(t-f==2) {f+=3; t--;}							 					// castles kingside
-  else {f-=4; t++;}														// castles queenside
-  FB=(A8<<f); TB=(A8<<t);												// bitmaps of move
-  (Gm->Piece[c][f]).type=3;												// move rook to origin square
-  j=(Gm->Piece[c][f]).index=(Gm->Piece[c][t]).index;					// move index to origin
-  (Gm->Piece[c][t]).type=(Gm->Piece[c][t]).index=0;						// clear rook from destination square
-  (Gm->Officer[c][j]).square=f;											// set rook origin square
-  (Gm->Psv[c]).Open+=Square[c][2][0][f]-Square[c][2][0][t];				// piece square value opening
-  (Gm->Psv[c]).End +=Square[c][2][1][f]-Square[c][2][1][t];				// piece square value endgame				
-  Gm->POSITION[c][0]^=TB|FB;	Gm->POSITION[c][3]^=TB|FB;				// move rook in type-bitmaps					
-  Gm->ROTATED[0]-=TB; Gm->ROTATED[0]|=FB;								// move rook in general bitmaps 							
-  for(j=1;j<4;j++)														// move rook in rotated bitmaps
-  {
-   s=shift[j+3][t]; Gm->ROTATED[j]-=s<128?TB<<s:TB>>(256-s);
-   s=shift[j+3][f]; Gm->ROTATED[j]|=s<128?FB<<s:FB>>(256-s);  
-  }
+  x=find_b[(SM^SM-1)%67]; SM&=SM-1;										// square of piece
+  c=(Gm->Piece[1][x]).type?1:0;											// color of piece
+  Gm->ATKF[x]=PieceAttacks(Gm,c,(Gm->Piece[c][x]).type,x);				// new attacks (0 for empty squares)
  }
- return;
 }
 
+#endif
+
 void 	PrintBM(BitMap BM)												// prints bitmap
 {
  Byte i;
@@ -2443,91 +3792,186 @@ void 	PrintBM(BitMap BM)												// prints bitmap
  printf(".\n");
 }
 
+double	WallTime()														// wall clock time in seconds
+{
+ struct timespec Ts;
+
+ clock_gettime(CLOCK_MONOTONIC,&Ts);									// monotonic clock
+ return (double)(Ts.tv_sec)+(double)(Ts.tv_nsec)/1e9;
+}
+
 void 	Divide(Game* Gm, Byte d)										// calculates divide
 {
- Game		Gam[Paras[93].Val];											// database for threads
- Mvs  		Mv,Mov[Paras[93].Val];
- BitMap		NOD;
- Dbyte  	m;
- Byte		i,j,t;
+ BitMap		NOD,Cnt[256];
+ Dbyte		Rm[256];
+ Byte		i;
  char 		Mo[10];
- clock_t 	t1;
- double		t2;
- 
- for(NOD=0;NOD<DEN;NOD++) for(i=0;i<16;i++) *(hash_t+NOD*16+i)=0;		// clear hash table															
- t1=clock();															// start stopwatch
- printf("Using %d thread(s) to calculate divide(%d)\n\n",Paras[93].Val,d);
- if(!d) {printf("0 leafs\n"); return;}									// trivial case	
- GenMoves(Gm,&Mv); if(!(Mv.cp&63)) {printf("0 leafs"); return;}			// generate moves, no moves
- NOD=0;	Gm->idepth=d-1; Gm->Finished=true; Gm->Currm=0; 				// initialize node count
- Mv.o=0; Mv.s=200; Mv.flg=0;											// init move picker
- for(i=0;i<Paras[93].Val;i++) {Mov[i]=Mv; Gam[i]=*Gm;}					// replicate thread databases
- i=j=t=0;
- do for(j=0;j<Paras[93].Val;j++)										// scan threads 
- {
-  if(Gam[j].Finished&&(Gam[j].idepth==d-1)&&Gam[j].Currm)				// thread finished a move
-  {
-   pthread_join(Gam[j].Tid,NULL);										// wait for thread and translate move
-   i++; UncodeMove(Gam[j].Currm,Mo);									// translate move 
-   printf("Thread %d: %2d. %s: %llu leafs\n",j+1,i,Mo,Gam[j].NODES);	// print thread, move and node count
-   NOD+=Gam[j].NODES; Gam[j].Currm=0; UnMove(Gam+j); t--;				// add nodes and unmake move
-  } 
-  if(Gam[j].Finished&&(Gam[j].idepth==d-1)&&(!(Gam[j].Currm)))			// free thread found
-   if(m=PickMove(Gm,&Mv))												// next move
-   { 
-    //pthread_join(Gam[j].Tid,NULL); 									// wait for thread
-	UncodeMove(m,Mo); 													// translate move
-	printf("Thread %d calculates move %s\n",j+1,Mo);					// inform about thread start
-    t++; Move(Gam+j,m); Gam[j].Finished=false; Gam[j].Currm=m;			// prepare thread with move
-    pthread_create(&Gam[j].Tid, NULL, PerftCount, (void*)(Gam+j));		// start thread
-   }
-  usleep(10000);														// prevent high cpu load of main thread
- } 
- while(t);																// threads still running
- t2=(double)(clock()-t1)/CLOCKS_PER_SEC;								// stop stopwatch
+ double		t1,t2;
+
+ t1=WallTime();															// start stopwatch
+ printf("Using %d thread(s) to calculate divide(%d)\n\n",Paras[93].Val+1,d);
+ if(!d) {printf("0 leafs\n"); return;}									// trivial case
+ NOD=PerftParallel(Gm,d,Rm,Cnt,1);										// count leafs of all root moves
+ for(i=0;Rm[i];i++)
+  {UncodeMove(Rm[i],Mo); printf("%2d. %s: %llu leafs\n",i+1,Mo,Cnt[i]);}// print move and node count
+ t2=WallTime()-t1;														// stop stopwatch
  printf("\n%d moves, %llu leafs of %d-ply tree\n",i,NOD,d);				// print result
- printf("(%.3lfs, %.0lf leafs/s)\n",t2,(double)(NOD/t2));				// print time	
+ printf("(%.3lfs, %.0lf leafs/s)\n",t2,(double)(NOD/t2));				// print time
 }
 
 void 	Perft(Game* Gm, Byte d)											// calculates perft
 {
- Game		Gam[Paras[93].Val];											// database for threads
- Mvs  		Mv,Mov[Paras[93].Val];
- BitMap		NOD;
- Dbyte  	m;
- Byte		i,j,t;
- clock_t 	t1;
- double		t2;
- 
- for(NOD=0;NOD<DEN;NOD++) for(i=0;i<16;i++) *(hash_t+NOD*16+i)=0;		// clear hash table														
- t1=clock();															// start stopwatch
- printf("Using %d thread(s) to calculate perft(%d):\n",Paras[93].Val,d);
+ BitMap		NOD,Cnt[256];
+ Dbyte		Rm[256];
+ Byte		i;
+ double		t1,t2;
+
+ t1=WallTime();															// start stopwatch
+ printf("Using %d thread(s) to calculate perft(%d):\n",Paras[93].Val+1,d);
  if(!d) {printf("0 leafs\n"); return;}									// trivial case
- GenMoves(Gm,&Mv); if(!(Mv.cp&63)) {printf("0 leafs"); return;}			// generate moves, no moves
- NOD=0;	Gm->idepth=d-1; Gm->Finished=true; Gm->Currm=0;  				// initialize node count
- Mv.o=0; Mv.s=200; Mv.flg=0;											// init move picker
- for(i=0;i<Paras[93].Val;i++) {Mov[i]=Mv; Gam[i]=*Gm;}					// replicate thread databases
- i=j=t=0;
- do for(j=0;j<Paras[93].Val;j++)										// scan threads 
+ NOD=PerftParallel(Gm,d,Rm,Cnt,1);										// count leafs of all root moves
+ for(i=0;Rm[i];i++);													// count root moves
+ t2=WallTime()-t1;														// stop stopwatch
+ printf("\n%d moves, %llu leafs of %d-ply tree\n",i,NOD,d);				// print result
+ printf("(%.3lfs, %.0lf leafs/s)\n",t2,(double)(NOD/t2));				// print time
+}
+
+void	PerftSuite(char* epd, Byte maxd)								// verifies perft counts of epd file (";D1 n ;D2 n")
+{
+ Game		*Gm;
+ FILE 		*fpr;
+ char		Line[500],Pos[200],*Is;
+ BitMap		NOD,EXP,SUM,ALL=0,Cnt[256];
+ Dbyte		Rm[256];
+ int		d,n=0,err=0;
+ double		t1,t2,T=0;
+ 
+ if(!(fpr=fopen(epd,"r"))) {printf("File does not exist!\n"); return;}	// open epd file for read
+ printf("Verifying perft counts of positions in file %s (max. depth %d) using %d thread(s)\n",epd,maxd,Paras[93].Val+1);
+ Gm=(Game*)malloc(sizeof(Game));										// game structure of suite
+
+ while((!err)&&(fgets(Line,500,fpr)))
  {
-  if(Gam[j].Finished&&(Gam[j].idepth==d-1)&&Gam[j].Currm)				// thread finished a move
+  if(!(Is=strchr(Line,';'))) 					continue;				// no perft annotations in line
+  d=(int)(Is-Line); if(d>150) 					continue;				// fen too long
+  strncpy(Pos,Line,d); strcpy(Pos+d," 0 1"); ParseFen(Gm,Pos); n++;	// get position (epd without move counters)
+  printf("\n%d. %.*s\n",n,(int)strcspn(Line,";\r\n"),Line);
+  t1=WallTime(); SUM=0;
+  for(;Is;Is=strchr(Is+1,';'))											// all annotations of position
   {
-   pthread_join(Gam[j].Tid,NULL);										// wait for thread and translate move
-   i++; NOD+=Gam[j].NODES; Gam[j].Currm=0; UnMove(Gam+j); t--;			// add nodes and unmake move 
-  } 
-  if(Gam[j].Finished&&(Gam[j].idepth==d-1)&&(!Gam[j].Currm))			// free thread found
-   if(m=PickMove(Gm,&Mv))												// next move
-   { 
-    
-    t++; Move(Gam+j,m); Gam[j].Finished=false; Gam[j].Currm=m;			// prepare thread with move
-    pthread_create(&Gam[j].Tid, NULL, PerftCount, (void*)(Gam+j));		// start thread
+   if((sscanf(Is,";D%d %llu",&d,&EXP)!=2)||(d<1)||(d>maxd)) continue;	// no perft annotation or too deep
+   NOD=PerftParallel(Gm,(Byte)d,Rm,Cnt,0);								// count leafs
+   printf("  D%d: %12llu %s\n",d,NOD,NOD==EXP?"ok":"FAILED");
+   if(NOD!=EXP) 														// wrong count: show divide and stop
+    {printf("expected %llu leafs\n\n",EXP); Divide(Gm,(Byte)d); err=1; break;}
+   SUM+=NOD;
+  }
+  t2=WallTime()-t1; T+=t2; ALL+=SUM;									// time and leafs of position
+  if(!err&&SUM) printf("  (%llu leafs, %.3lfs, %.0lf leafs/s)\n",SUM,t2,(double)(SUM/t2));
+ }
+ fclose(fpr); free(Gm);
+ if(err) printf("\nperftsuite stopped at position %d\n",n);
+ else printf("\n%d positions ok, %llu leafs in %.3lfs (%.0lf leafs/s)\n",n,ALL,T,T>0?(double)(ALL/T):0);
+}
+
+BitMap	PerftParallel(Game* Gm, Byte d, Dbyte* Rm, BitMap* Cnt, Byte v)	// task based perft with work stealing
+{
+ Mvs		Mv;
+ Dbyte		Path[16];
+ BitMap		NOD=0;
+ Fbyte		i,n;
+
+ Rm[0]=0; Cnt[0]=0;
+ memset(perft_t,0,DEN*64);												// clear perft table, search TT is untouched
+ NOD=0; GenMoves(Gm,&Mv); if(!(Mv.cp&63)) return 0;						// generate moves, no moves
+ Mv.o=0; Mv.s=200; Mv.flg=0; n=0;										// init move picker
+ while((Rm[n]=PickMove(Gm,&Mv))) Cnt[n++]=0;							// root moves
+ 
+ PTL=min((Byte)(Paras[107].Val),d-1); if(!PTL) PTL=1; PDepth=d-PTL;		// split depth and depth of tasks
+ PTN=0; PTC=1024; PTask=(Dbyte*)malloc(PTC*(PTL+1)*sizeof(Dbyte));		// task list
+ for(i=0;i<n;i++)														// split root moves into tasks
+  {Path[0]=i; Path[1]=Rm[i]; Move(Gm,Rm[i]); PerftTasks(Gm,1,Path); UnMove(Gm);}
+ PCnt=(BitMap*)malloc((PTN+1)*sizeof(BitMap));							// node counts of tasks
+
+ PWN=Paras[93].Val+1; PDone=0;											// number of workers
+ PW=(Pwork*)malloc(PWN*sizeof(Pwork));									// worker data
+ for(i=0;i<PWN;i++)														// distribute tasks to workers
+ {
+  PW[i].Gm=(Game*)malloc(sizeof(Game)); *(PW[i].Gm)=*Gm;				// game copy of worker
+  PW[i].R=((BitMap)(PTN*(i+1)/PWN)<<32)|(BitMap)(PTN*i/PWN);			// task range
+  PW[i].NODES=PW[i].tasks=PW[i].steals=0; PW[i].n=i;
+  pthread_create(&(PW[i].Tid),NULL,PerftWorker,(void*)(PW+i));			// start worker
+ }
+ pthread_mutex_lock(&PMutex);											// wait for completion counter
+ while(PDone<PWN) pthread_cond_wait(&PCond,&PMutex);
+ pthread_mutex_unlock(&PMutex);
+ 
+ for(i=0;i<PTN;i++) Cnt[PTask[i*(PTL+1)]]+=PCnt[i];						// node counts of root moves
+ for(i=0;i<PWN;i++)
+ {
+  pthread_join(PW[i].Tid,NULL); NOD+=PW[i].NODES; 						// sum up node counts
+  if(v) printf("Thread %lu: %lu tasks (%lu stolen), %llu leafs\n",i+1,		// per thread load
+  		PW[i].tasks,PW[i].steals,PW[i].NODES);
+  free(PW[i].Gm);
+ }
+ free(PW); free(PTask); free(PCnt); PTask=NULL; PCnt=NULL;
+ return NOD;
+}
+
+void	PerftTasks(Game* Gm, Byte d, Dbyte* Path)						// collect move sequences down to split depth
+{
+ Mvs	Mv;
+ Dbyte	m;
+
+ if(d==PTL)																// split depth reached: store task
+ {
+  if(PTN==PTC) {PTC*=2; PTask=(Dbyte*)realloc(PTask,PTC*(PTL+1)*sizeof(Dbyte));}// enlarge task list
+  memcpy(PTask+PTN*(PTL+1),Path,(PTL+1)*sizeof(Dbyte)); PTN++;			// root move index and move sequence
+  return;
+ }
+ GenMoves(Gm,&Mv); Mv.o=0; Mv.s=200; Mv.flg=0;							// generate moves, init move picker
+ while((m=PickMove(Gm,&Mv)))
+  {Path[d+1]=m; Move(Gm,m); PerftTasks(Gm,d+1,Path); UnMove(Gm);}		// next ply
+}
+
+void	*PerftWorker(void *Pe)											// perft worker thread
+{
+ Pwork	*W=(Pwork*)(Pe),*V;
+ Game	*Gm=W->Gm;
+ BitMap	R;
+ Fbyte	t,i;
+ Byte	k;
+
+ while(1)
+ {
+  R=W->R;																// own task range
+  if((Fbyte)(R&0xFFFFFFFF)<(Fbyte)(R>>32))								// own task left: take from the front
+  {
+   if(!__sync_bool_compare_and_swap(&(W->R),R,R+1)) continue;			// range changed by thief, retry
+   t=(Fbyte)(R&0xFFFFFFFF);
+  }
+  else																	// steal from the back of other queues
+  {
+   t=PTN; for(i=1;(i<PWN)&&(t==PTN);i++)
+   {
+    V=PW+(W->n+i)%PWN; R=V->R;
+    while((Fbyte)(R&0xFFFFFFFF)<(Fbyte)(R>>32))							// victim has tasks left
+    {
+     if(__sync_bool_compare_and_swap(&(V->R),R,R-((BitMap)(1)<<32)))	// take last task
+      {t=(Fbyte)(R>>32)-1; (W->steals)++; break;}
+     R=V->R;
+    }
    }
-  usleep(10000);														// prevent high cpu load of main thread
- } 
- while(t);																// threads still running
- t2=(double)(clock()-t1)/CLOCKS_PER_SEC;								// stop stopwatch
- printf("\n%d moves, %llu leafs of %d-ply tree\n",i,NOD,d);				// print result
- printf("(%.3lfs, %.0lf leafs/s)\n",t2,(double)(NOD/t2));				// print time
+   if(t==PTN) break;													// no tasks left anywhere
+  }
+  for(k=1;k<=PTL;k++) Move(Gm,PTask[t*(PTL+1)+k]);						// play move sequence of task
+  Gm->idepth=PDepth; PerftCount((void*)(Gm));							// count leafs
+  for(k=1;k<=PTL;k++) UnMove(Gm);										// take back move sequence
+  PCnt[t]=Gm->NODES; W->NODES+=Gm->NODES; (W->tasks)++;					// node count of task and worker
+ }
+ pthread_mutex_lock(&PMutex); PDone++;									// increase completion counter
+ pthread_cond_signal(&PCond); pthread_mutex_unlock(&PMutex);
+ return NULL;
 }
 
 void 	*PerftCount(void *Pe)											// recursive perft
@@ -2565,21 +4009,32 @@ void 	*PerftCount(void *Pe)											// recursive perft
 
 void 	StoreHashP(Game* Gm, BitMap NOD)								// store perft hash entry
 {
- BitMap KEY,LOCK;
+ BitMap LOCK,DAT,*E;
+ Byte	i,j=0,d,dmin=255;
 
- LOCK=(Gm->Moves[Gm->Move_n]).HASH; KEY=(LOCK%DEN)*16;					// calculate hash key (modulo entries)
- *(BitMap*)(hash_t+KEY)=NOD; *(BitMap*)(hash_t+KEY+8)=(LOCK^NOD);		// store nodes and lock with consistency check
+ LOCK=(Gm->Moves[Gm->Move_n]).HASH; E=(BitMap*)(perft_t+(LOCK%DEN)*64);	// bucket of 4 entries (data,lock)
+ for(i=0;i<4;i++)														// select entry to replace
+ {
+  DAT=E[2*i]; d=(Byte)(DAT>>56);
+  if((E[2*i+1]==(LOCK^DAT))&&(d==(Byte)(NOD>>56))) {j=i; break;}		// same position and depth
+  if(!DAT) {j=i; break;}												// empty entry
+  if(d<dmin) {dmin=d; j=i;}												// lowest depth is replaced
+ }
+ E[2*j]=NOD; E[2*j+1]=(LOCK^NOD);										// store nodes and lock with consistency check
  return;			
 }
 
 BitMap 	GetHashP(Game* Gm)												// get perft hash entry
 {
- BitMap KEY,LOCK,NOD,LOCK1;
+ BitMap LOCK,DAT,*E;
+ Byte	i;
 
- TTACC++;																// count tt access
- LOCK=(Gm->Moves[Gm->Move_n]).HASH; KEY=(LOCK%DEN)*16;					// calculate hash key (modulo entries)
- NOD=*(BitMap*)(hash_t+KEY); LOCK1=*(BitMap*)(hash_t+KEY+8); 			// get stored data
- if(LOCK1==(LOCK^NOD)) {TTHIT1++; return NOD;}							// consistent entry found, count hits
+ LOCK=(Gm->Moves[Gm->Move_n]).HASH; E=(BitMap*)(perft_t+(LOCK%DEN)*64);	// bucket of 4 entries (data,lock)
+ for(i=0;i<4;i++)														// scan bucket
+ {
+  DAT=E[2*i];															// data is read once, torn entries fail the lock
+  if((E[2*i+1]==(LOCK^DAT))&&(Gm->idepth==(Byte)(DAT>>56))) return DAT;	// consistent entry of the right depth found
+ }
  return -1;																// no entry found or not consistent
 }
 
@@ -2649,189 +4104,446 @@ short 	Popcount(BitMap BM)												// counts set bits
  return (BM * 0x0101010101010101) >> 56;         						// horizontal sum of bytes
 }
 
+BitMap	Spawn(BitMap BM, Byte d)										// squares in front of pieces on their files, d=0: towards rank 8
+{
+ if(d) {BM<<=8; BM|=BM<<8; BM|=BM<<16; BM|=BM<<32;}						// fill towards rank 1
+ else  {BM>>=8; BM|=BM>>8; BM|=BM>>16; BM|=BM>>32;}						// fill towards rank 8
+ return BM;
+}
+
+BitMap	SpawnStop(BitMap BM, BitMap EM, Byte d)							// spawn through empty squares EM up to the first occupied one
+{
+ if(d)																	// occluded fill towards rank 1
+ {
+  BM|=EM&(BM<<8);  EM&=EM<<8;
+  BM|=EM&(BM<<16); EM&=EM<<16;
+  BM|=EM&(BM<<32); return BM<<8;
+ }
+ BM|=EM&(BM>>8);  EM&=EM>>8;											// occluded fill towards rank 8
+ BM|=EM&(BM>>16); EM&=EM>>16;
+ BM|=EM&(BM>>32); return BM>>8;
+}
+
+BitMap	Sides(BitMap BM)												// squares with a neighbour in BM on the same rank
+{
+ return ((BM&PA)>>1)|((BM&PH)<<1);
+}
+
+BitMap	BothSides(BitMap BM)											// squares with neighbours in BM on both sides
+{
+ return ((BM&PA)>>1)&((BM&PH)<<1);
+}
+
 Dbyte Book(Game* Gm)
 {
- int	i;
- Byte	r,k,t,f;
- Dbyte	Mov,Mov2,Om[100];
- Game	GmTest;
- Mvs	Mv;
- BitMap	BM;
- 
+ Fbyte	i,n;
+ Dbyte	Mov;
 
+ if(PolyBook) if((Mov=PolyProbe(Gm)))					return(Mov);	// external book move found
  if(!Options[2].Val)									goto Tree;		// no position library
- k=0; Mov=0; for(i=0;i<sizeof(AOB_POS)/8;i++)							// search position in opening book
-  if(!((AOB_POS[i]^(Gm->Moves[Gm->Move_n]).HASH)>>15)) k++;				// k moves found
- if(!k)													goto Tree;		// no move found
- r=rand()%k; k=0;
- for(i=0;i<sizeof(AOB_POS)/8;i++)										// search position in opening book
-  if((!((AOB_POS[i]^(Gm->Moves[Gm->Move_n]).HASH)>>15))&&(k++==r))		// randomly selected position found
-   {Mov=(Dbyte)(AOB_POS[i]&0x7FFF); break;}								// get the move
- if(Mov)																// check if move is legal
- {
-  GenMoves(Gm,&Mv); if(!Mv.cp)							return(0);		// no move possible
-  t=56-(Mov&56)+(Mov&7); Mov>>=6; f=56-(Mov&56)+(Mov&7);				// extract origin and destination
-  if(!(r=(Gm->Piece[Gm->color][f]).type))				goto Tree;		// piece on origin does not exist
-  if(r==1) if(f==60) 	 {if(t==63) t=62; else if(t==56) t=58;}			// correct castles target
-  		   else if(f==4) {if(t==7)  t=6;  else if(!t)    t=2;}
-  BM=(A8<<t); 
-  if(r<6) {if(!(Mv.OFFM[(Gm->Piece[Gm->color][f]).index]&BM)) goto Tree;}//officer move not possible
-  else if((t-f==16)||(f-t==16)) {if(!(BM&Mv.PAWM[3])) goto Tree;}		// double step pawn move not possible
-  else {r=9-16*Gm->color+t-f; if((r>2)||(!(BM&Mv.PAWM[r]))) goto Tree;}	// pawn move not possible
-  Mov2=(t<<8)+f; if(r=(Mov>>6)) Mov2+=((4-r)<<14)+128; return(Mov2);	// translate move from polyglot format													
- }
+ i=BookFind(AOB_POS,sizeof(AOB_POS)/8-1,(Gm->Moves[Gm->Move_n]).HASH,15,&n);	// sorted opening book without trailing 0
+ if(!n)													goto Tree;		// no move found
+ if((Mov=PolyMove(Gm,(Dbyte)(AOB_POS[i+rand()%n]&0x7FFF))))	return(Mov);// randomly selected move is legal
  
  Tree:
  if(!Options[1].Val)									return(0);		// no position library
- GetPosition(&GmTest,Startpos);											// start from initial position
- i=0; k=0; Mov=0; BM=(Gm->Moves[Gm->Move_n]).HASH;							
- while(Mov=Aob_tre[i++])												// parse database
-  if((f=(Mov&0xFF))==(Mov>>8)) for(t=0;t<f;t++) UnMove(&GmTest);		// end of opening line, take back f moves
-  else
-  {
-   if(BM==(GmTest.Moves[GmTest.Move_n]).HASH) if(!(Mov&64)) Om[k++]=Mov;// Position found, record move
-   Move(&GmTest,Mov&0xFFBF);											// make move
-  }
- if(k) 											return(Om[rand()%k]);	// pick random move
+ i=BookFind(TreeIdx,TreeN,(Gm->Moves[Gm->Move_n]).HASH,16,&n);			// search position in tree book index
+ if(n) 							return((Dbyte)(TreeIdx[i+rand()%n]));	// pick random move
  												return(0);				// position not found
 }
 
-bool 	SEE(Game *Gm, Dbyte Mov, short Thr)								// SEE of move larger or equal threshold?
+Dbyte	PolyMove(Game* Gm, Dbyte Mov)									// translate polyglot move, check legality
 {
- short	Val;
- Byte 	f,t,p,s,pm,a,pn;
- BitMap BM,BO[4],OM;
+ Byte	r,t,f;
+ Dbyte	Mov2;
+ Mvs	Mv;
+ BitMap	BM;
 
- if(Mov&128) return true;												// promotion
- t=(Byte)(Mov>>8)&63; f=(Byte)(Mov)&63;									// origin and destination
- if(p=(Gm->Piece[1-Gm->color][t]).type) 								// possible SEE gain is value of piece on destination
- 	Val=(Paras[3+p].Val+Paras[99+p].Val)/2; 			
- else Val=0;
- if(Val<Thr) return false;												// value of piece to gain is lower than threshold
- BM=(A8<<f); BO[0]=(Gm->ROTATED[0]&ATC[0][t])&(~(BM|(A8<<t)));			// potential attackers of destination square
- if(!(BO[0]&(Gm->POSITION[1-Gm->color][0]))) return true;				// no attackers: gain is piece value
- for(p=1;p<4;p++) 
+ if(!Mov)												return(0);		// no move
+ GenMoves(Gm,&Mv); if(!Mv.cp)							return(0);		// no move possible
+ t=56-(Mov&56)+(Mov&7); Mov>>=6; f=56-(Mov&56)+(Mov&7);					// extract origin and destination
+ if(!(r=(Gm->Piece[Gm->color][f]).type))				return(0);		// piece on origin does not exist
+ if(r==1) {if(f==60)	 {if(t==63) t=62; else if(t==56) t=58;}			// correct castles target
+  		   else if(f==4) {if(t==7)  t=6;  else if(!t)    t=2;}}
+ BM=(A8<<t); 
+ if(r<6) {if(!(Mv.OFFM[(Gm->Piece[Gm->color][f]).index]&BM)) return(0);}// officer move not possible
+ else if((t-f==16)||(f-t==16)) {if(!(BM&Mv.PAWM[3])) 	return(0);}		// double step pawn move not possible
+ else {r=9-16*Gm->color+t-f; if((r>2)||(!(BM&Mv.PAWM[r]))) return(0);}	// pawn move not possible
+ Mov2=(t<<8)+f; if(r=(Mov>>6)) Mov2+=((4-r)<<14)+128; return(Mov2);	// translate move from polyglot format
+}
+
+Dbyte	PolyProbe(Game* Gm)												// weighted move from external polyglot book
+{
+ Fbyte	lo=0,hi=PolyN,m,i,W=0;
+ Byte	*E;
+ BitMap	K=(Gm->Moves[Gm->Move_n]).HASH;									// engine hash is the polyglot key
+
+ while(lo<hi)															// binary search of first entry (big endian keys)
+  {m=(lo+hi)/2; if(__builtin_bswap64(*(BitMap*)(PolyBook+16*m))<K) lo=m+1; else hi=m;}
+ for(i=lo;(i<PolyN)&&(__builtin_bswap64(*(BitMap*)(PolyBook+16*i))==K);i++)
+  W+=(PolyBook[16*i+10]<<8)|PolyBook[16*i+11];							// sum of weights
+ if(!W)													return(0);		// position not in book
+ W=rand()%W;															// weighted random selection
+ for(E=PolyBook+16*lo;W>=(Fbyte)((E[10]<<8)|E[11]);E+=16) W-=(E[10]<<8)|E[11];
+ return(PolyMove(Gm,((E[8]<<8)|E[9])&0x7FFF));							// move (bytes 8-9) if legal
+}
+
+void	OpenBook(char* File)											// map external polyglot book
+{
+#if defined(_WIN32)
+ FILE	*fp;
+ if(PolyBook) free(PolyBook);											// release previous book
+ PolyBook=NULL; PolyN=0;
+ if(!(*File)||!strcmp(File,"<empty>")||!(fp=fopen(File,"rb"))) goto Done;// no book or file not found
+ fseek64(fp,0,SEEK_END); PolyN=ftell64(fp)/16; fseek64(fp,0,SEEK_SET);	// number of 16 byte entries
+ PolyBook=(Byte*)malloc(16*PolyN+16);									// windows: read file into memory
+ if(fread(PolyBook,16,PolyN,fp)!=PolyN) {free(PolyBook); PolyBook=NULL; PolyN=0;}
+ fclose(fp);
+#else
+ int	fd;
+ struct stat St;
+ if(PolyBook) munmap(PolyBook,16*PolyN);								// release previous book
+ PolyBook=NULL; PolyN=0;
+ if(!(*File)||!strcmp(File,"<empty>")||((fd=open(File,O_RDONLY))<0)) goto Done;// no book or file not found
+ if(!fstat(fd,&St)&&(St.st_size>=16))									// map file read only, pages are loaded on demand
  {
-  s=shift[p+3][f]; 
-  BO[p]=Gm->ROTATED[p]&~(s<128?BM<<s:BM>>(256-s));						// remove moving piece from rotated bitmaps
+  PolyBook=(Byte*)mmap(NULL,St.st_size&~(off_t)(15),PROT_READ,MAP_SHARED,fd,0);
+  if(PolyBook==MAP_FAILED) PolyBook=NULL; else PolyN=St.st_size/16;
  }
- pm=(Gm->Piece[Gm->color][f]).type;										// moving piece type
- while(BO[0])															// parse potential attackers
+ close(fd);
+#endif
+ Done:
+ if(PolyBook) printf("info string BookFile %s: %lu entries\n",File,PolyN);
+ else if(*File&&strcmp(File,"<empty>")) printf("info string BookFile %s not found\n",File);
+ fflush(stdout);
+}
+
+Dbyte	SanMove(Game* Gm, char* San)									// translates move in SAN notation, 0 if illegal
+{
+ Mvs	Mv;
+ Dbyte	Mov;
+ char	S[16],*c;
+ const char *Pc="KQRBN";												// piece symbols
+ Byte	l,p=6,pr=0,f,t,df=8,dr=8;
+
+ strncpy(S,San,15); S[15]=0; l=(Byte)strlen(S);
+ while(l&&strchr("+#!?",S[l-1])) S[--l]=0;								// remove check and annotation symbols
+ if(!strncmp(S,"O-O",3)||!strncmp(S,"0-0",3))							// castles
+ {
+  f=Gm->color?4:60; t=(l>4)?f-2:f+2; p=1;								// king moves two squares
+ }
+ else
+ {
+  if(l<2) 												return(0);		// no move
+  if((c=strchr(S,'='))) {*c=0; pr=c[1]; l=(Byte)strlen(S);}				// promotion with '='
+  else if(strchr("QRBN",S[l-1])) {pr=S[l-1]; S[--l]=0;}					// promotion without '='
+  if(l<2) 												return(0);
+  if(S[0]&&strchr(Pc,S[0])) p=(Byte)(strchr(Pc,S[0])-Pc)+1;			// piece type (k=1,..,n=5, p=6)
+  t=(Byte)(S[l-2]-'a'+8*('8'-S[l-1])); if(t>63)			return(0);		// destination
+  for(c=S+(p<6);c<S+l-2;c++)											// disambiguation
+   if((*c>='a')&&(*c<='h')) df=*c-'a'; else if((*c>='1')&&(*c<='8')) dr='8'-*c;
+  f=64;
+ }
+ GenMoves(Gm,&Mv); Mv.o=0; Mv.s=200; Mv.flg=0;							// generate legal moves
+ while((Mov=PickMove(Gm,&Mv)))
+ {
+  if((Byte)((Mov>>8)&63)!=t) continue;									// wrong destination
+  if((f<64)&&((Byte)(Mov&63)!=f)) continue;								// wrong origin (castles)
+  if((Gm->Piece[Gm->color][Mov&63]).type!=p) continue;					// wrong piece type
+  if((df<8)&&((Mov&7)!=df)) continue;									// wrong file of origin
+  if((dr<8)&&(((Mov&63)>>3)!=dr)) continue;								// wrong rank of origin
+  if(pr&&(Mov&128)&&strchr(Pc+1,pr)) Mov+=(Dbyte)(strchr(Pc+1,pr)-Pc-1)<<14;// under promotion
+  return(Mov);
+ }
+ return(0);
+}
+
+Dbyte	PolyCode(Game* Gm, Dbyte Mov)									// translates move to polyglot format
+{
+ Byte	f=Mov&63,t=(Mov>>8)&63;
+
+ if(((Gm->Piece[Gm->color][f]).type==1)&&((f==4)||(f==60)))				// castles: king takes rook
+  {if(t==f+2) t=f+3; else if(t==f-2) t=f-4;}
+ return(((7-(f>>3))<<9)|((f&7)<<6)|((7-(t>>3))<<3)|(t&7)|((Mov&128)?(4-((Mov>>14)&3))<<12:0));
+}
+
+void	BookAdd(Bmap* B, BitMap K, Dbyte Mov, Fbyte Cnt)				// add move frequency of position to book map
+{
+ Fbyte	i,h;
+ Bnode	*N;
+
+ h=(Fbyte)((K^(K>>29)^Mov)&(B->Size-1));								// bucket
+ for(i=B->Head[h];i;i=N->next)											// scan chain
+  {N=B->Blk[i>>16]+(i&0xFFFF); if((N->key==K)&&(N->mov==Mov)) {N->cnt+=Cnt; return;}}
+ if(!B->Blk[B->N>>16]) B->Blk[B->N>>16]=(Bnode*)malloc(0x10000*sizeof(Bnode));// new arena block
+ N=B->Blk[B->N>>16]+(B->N&0xFFFF);
+ N->key=K; N->mov=Mov; N->cnt=Cnt; N->next=B->Head[h]; B->Head[h]=B->N++;// insert node in front of chain
+ if(B->N>2*B->Size)														// too many nodes: double buckets, relink arena
  {
-  if(Val-((Paras[3+pm].Val+Paras[99+pm].Val)/2)>=Thr) return true;		// even if piece is lost, move is worthwhile
-  a=0; pn=7; while((!a)&&(--pn))										// parse potential attackers 
-  if(OM=(Gm->POSITION[1-Gm->color][pn]&ATC[pn][t]&BO[0])) switch(pn)	// potential attacker exists
+  free(B->Head); B->Size*=2; B->Head=(Fbyte*)calloc(B->Size,sizeof(Fbyte));
+  for(i=1;i<B->N;i++)
   {
-   case 2: if(BM=(SLIDE[t][0][BO[0]>>shift[0][t]&255]&OM))
-   			{a=1; break;}
-		   if(BM=(SLIDE[t][1][BO[1]>>shift[1][t]&255]&OM))	
-   	        {a=1; break;}												// queen is real attacker
-   case 4: if(BM=(SLIDE[t][2][BO[2]>>shift[2][t]&255]&OM))
-   			{a=1; break;}
-   		   if(BM=(SLIDE[t][3][BO[3]>>shift[3][t]&255]&OM))	
-   	        a=1; break;													// bishop or queen is real attacker   	
-   case 3: if(BM=(SLIDE[t][0][BO[0]>>shift[0][t]&255]&OM))
-   			{a=1; break;}
-   		   if(BM=(SLIDE[t][1][BO[1]>>shift[1][t]&255]&OM))
-   			a=1; break;													// rook is real attacker
-   case 6: if(BM=(STEP[3+Gm->color][t]&OM)) a=1; break;					// pawn is real attacker
-   default: BM=OM; a=1;													// king or knight is real attacker
+   N=B->Blk[i>>16]+(i&0xFFFF); h=(Fbyte)((N->key^(N->key>>29)^N->mov)&(B->Size-1));
+   N->next=B->Head[h]; B->Head[h]=i;
   }
-  if(!a) return (Val>=Thr);												// no more attackers: value is definite
-  Val-=(Paras[3+pm].Val+Paras[99+pm].Val)/2; 							// subtract attacked piece value, 
-  if(Val+(Paras[3+pn].Val+Paras[99+pn].Val)/2<Thr) return false;		// even if attacker is captured value is below threshold
-  BM&=-BM; BO[0]&=~BM; f=find_b[(BM^BM-1)%67];							// pick one attacker and remove, square of attacker
-  for(p=1;p<4;p++)
+ }
+}
+
+void	*BookWorker(void *Pe)											// parse range of pgn file
+{
+ Bmap	*B=(Bmap*)(Pe);
+ Game	*Gm;
+ FILE	*fp;
+ char	Line[10000],Fen[200],*Tk,*Nx,*Is;
+ BitMap	o;
+ int	cm=0,vr=0,ply=0,on=0;
+ Dbyte	Mov;
+
+ if(!(fp=fopen(BBFile,"r"))) return NULL;
+ Gm=(Game*)malloc(sizeof(Game)); fseek64(fp,B->Start,SEEK_SET);
+ while(1)
+ {
+  o=ftell64(fp); if(!fgets(Line,10000,fp)) break;						// offset and next line
+  if(!strncmp(Line,"[Event ",7))										// new game
   {
-   s=shift[p+3][f]; BO[p]&=~(s<128?BM<<s:BM>>(256-s));					// remove attacker from rotated bitmaps
+   if(o>=B->End) break;													// game belongs to next range
+   ParseFen(Gm,Startpos); ply=cm=vr=0; on=1; (B->Games)++;				// start position
   }
-  a=0; pm=7; while((!a)&&(--pm))										// parse potential defenders
-  if(OM=(Gm->POSITION[Gm->color][pm]&ATC[pm][t]&BO[0])) switch(pm)		// potential defender exists 
+  if(!on) continue;														// skip until first game of range
+  if(Line[0]=='[')														// tag
   {
-   case 2: if(BM=(SLIDE[t][0][BO[0]>>shift[0][t]&255]&OM))
-   			{a=1; break;}
-		   if(BM=(SLIDE[t][1][BO[1]>>shift[1][t]&255]&OM))	
-   	        {a=1; break;}												// queen is real defender
-   case 4: if(BM=(SLIDE[t][2][BO[2]>>shift[2][t]&255]&OM))
-   			{a=1; break;}
-   		   if(BM=(SLIDE[t][3][BO[3]>>shift[3][t]&255]&OM))	
-   	        a=1; break;													// bishop or queen is real defender   	
-   case 3: if(BM=(SLIDE[t][0][BO[0]>>shift[0][t]&255]&OM))
-   			{a=1; break;}
-   		   if(BM=(SLIDE[t][1][BO[1]>>shift[1][t]&255]&OM))
-   			a=1; break;													// rook is real defender
-   case 6: if(BM=(STEP[4-Gm->color][t]&OM)) a=1; break;					// pawn is real defender
-   default: BM=OM; a=1;													// king or knight is real defender
+   if((!strncmp(Line,"[FEN \"",6))&&(Is=strchr(Line+6,'"')))			// setup position
+    {*Is=0; strncpy(Fen,Line+6,190); Fen[190]=0; strcat(Fen," "); ParseFen(Gm,Fen);}
+   continue;
+  }
+  for(Nx=Line;*(Tk=Nx+strspn(Nx," \t\r\n"));)							// movetext tokens (strtok is not thread safe)
+  {
+   Nx=Tk+strcspn(Tk," \t\r\n"); if(*Nx) *Nx++=0;						// terminate token, start of next token
+   for(;*Tk;Tk++)														// comments and variations
+   {
+    if(cm) {if(*Tk=='}') cm=0; continue;}
+    if(*Tk=='{') {cm=1; continue;}
+    if(*Tk=='(') {vr++; continue;}
+    if(*Tk==')') {if(vr) vr--; continue;}
+    if(vr) continue;
+    break;
+   }
+   if(*Tk==';') 										break;			// comment until end of line
+   if(!*Tk||(*Tk=='$')||(on!=1)) 						continue;		// nothing left, nag or game finished
+   if((Is=strpbrk(Tk,"({")))											// comment or variation after move
+    {if(*Is=='{') cm=!strchr(Is,'}'); else vr+=!strchr(Is,')'); *Is=0;}
+   if(!strcmp(Tk,"1-0")||!strcmp(Tk,"0-1")||!strcmp(Tk,"1/2-1/2")||!strcmp(Tk,"*")) {on=2; continue;}
+   if(isdigit(*Tk)&&strncmp(Tk,"0-0",3)) 								// move number
+    {while(isdigit(*Tk)) Tk++; while(*Tk=='.') Tk++; if(!*Tk) continue;}
+   if(ply>=BBMaxply) {on=2; continue;}									// maximum book depth reached
+   if(!(Mov=SanMove(Gm,Tk))) {on=2; (B->Errors)++; continue;}			// illegal move: skip rest of game
+   BookAdd(B,(Gm->Moves[Gm->Move_n]).HASH,PolyCode(Gm,Mov),1);			// count move in position
+   Move(Gm,Mov); ply++; (B->Moves)++;
   }
-    
-  if(!a) return (Val>=Thr);												// no more defenders: value is definite
-  Val+=(Paras[3+pn].Val+Paras[99+pn].Val)/2;							// add defenders piece value
-  BM&=-BM; BO[0]&=~BM; f=find_b[(BM^BM-1)%67];							// pick one defender and remove, square of defender
-  for(p=1;p<4;p++)
-   {s=shift[p+3][f]; BO[p]&=~(s<128?BM<<s:BM>>(256-s));}				// remove defender from rotated bitmaps
  }
- return false;
+ fclose(fp); free(Gm);
+ return NULL;
 }
 
-short 	MatEval(Game* Gm)												// material+pst+stm evaluation
+int		CompareBnode(const void* a, const void* b)						// compare book nodes by key, frequency
 {
- BitMap	LOCK,PM,QM;
- short	Pa,Pw,Pb,Val,j,p,v[5];
- Byte	i;
+ const Bnode *x=*(const Bnode**)a,*y=*(const Bnode**)b;
 
- p=min(Gm->phase,24);													// game phase
- 
- LOCK=*(BitMap*)(mhash_t+((Gm->MHASH)%MEN)*8); Val=(short)(LOCK);		// material hash entry
- if((short)((LOCK^Gm->MHASH)>>16)!=Val)									// entry does not fit or crc wrong
+ if(x->key!=y->key) return (x->key>y->key)-(x->key<y->key);
+ return (x->cnt<y->cnt)-(x->cnt>y->cnt);
+}
+
+void	BuildBook(char* Pgn, char* Out, int maxply, int minfreq)		// build book from pgn file
+{
+ Bmap	*B;
+ Bnode	**S,*N;
+ FILE	*fp;
+ Fbyte	i,j,n,T;
+ BitMap	Size;
+ Byte	E[16];
+ double	t1;
+ int	b;
+
+ if(!(fp=fopen(Pgn,"rb"))) {printf("File does not exist!\n"); return;}	// open pgn file
+ fseek64(fp,0,SEEK_END); Size=ftell64(fp); fclose(fp);					// size of pgn file
+ T=Paras[93].Val+1; t1=WallTime();										// number of threads
+ strncpy(BBFile,Pgn,255); BBMaxply=min(maxply,400);					// parameters of workers
+ printf("Building book from %s (max. %d plies, min. frequency %d) using %lu thread(s) ...\n",Pgn,BBMaxply,minfreq,T);
+ B=(Bmap*)calloc(T,sizeof(Bmap));
+ for(i=0;i<T;i++)														// split file into ranges
+ {
+  B[i].Start=Size*i/T; B[i].End=Size*(i+1)/T; B[i].N=1;					// node 0 is end of chain
+  B[i].Size=0x10000; B[i].Head=(Fbyte*)calloc(B[i].Size,sizeof(Fbyte));
+  pthread_create(&(B[i].Tid),NULL,BookWorker,(void*)(B+i));
+ }
+ for(i=0;i<T;i++) pthread_join(B[i].Tid,NULL);
+ for(i=1;i<T;i++)														// merge maps into first map
+ {
+  for(j=1;j<B[i].N;j++) {N=B[i].Blk[j>>16]+(j&0xFFFF); BookAdd(B,N->key,N->mov,N->cnt);}
+  for(j=0;j<=(B[i].N-1)>>16;j++) free(B[i].Blk[j]);					// release arena of merged map
+  free(B[i].Head); B->Games+=B[i].Games; B->Moves+=B[i].Moves; B->Errors+=B[i].Errors;
+ }
+ S=(Bnode**)malloc(B->N*sizeof(Bnode*)); n=0;							// entries with minimum frequency
+ for(j=1;j<B->N;j++) {N=B->Blk[j>>16]+(j&0xFFFF); if(N->cnt>=(Fbyte)minfreq) S[n++]=N;}
+ qsort(S,n,sizeof(Bnode*),CompareBnode);								// sort by position key
+
+ if((b=(strlen(Out)>4)&&!strcmp(Out+strlen(Out)-4,".bin")))				// polyglot book
+ {
+  if((fp=fopen(Out,"wb"))) for(j=0;j<n;j++)
+  {
+   for(i=0;i<8;i++) E[i]=(Byte)(S[j]->key>>(56-8*i));					// big endian key, move, weight
+   E[8]=S[j]->mov>>8; E[9]=(Byte)(S[j]->mov); i=(Fbyte)min(S[j]->cnt,0xFFFF);
+   E[10]=(Byte)(i>>8); E[11]=(Byte)(i); E[12]=E[13]=E[14]=E[15]=0;
+   fwrite(E,16,1,fp);
+  }
+ }
+ else if((fp=fopen(Out,"w")))											// astimate position format
  {
-  for(i=0;i<5;i++) v[i]=(p*Paras[5+i].Val+(24-p)*Paras[101+i].Val)/48;	// calculate material values dependent on game phase
-  Pw= Pb=0;																// initialize piece value
-  for(i=1;i<(Gm->Count[0]).officers;i++) 								// accumulate piece values white
-   Pw+=v[(Gm->Officer[0][i]).type-2];  							
-  for(i=1;i<(Gm->Count[1]).officers;i++) 								// accumulate piece values black
-   Pb+=v[(Gm->Officer[1][i]).type-2]; 								
+  fprintf(fp,"// Opening book for Astimate3 generated from %s with %lu positions/moves \n\n",Pgn,n);
+  for(j=0;j<n;j++)
+   fprintf(fp,"0x%016llx,%s",(S[j]->key&0xFFFFFFFFFFFF8000)|S[j]->mov,(j%6==5)?"\n":"");
+  fprintf(fp,"0x0000000000000000\n");									// terminating 0 entry as in Astimate2.pos
+ }
+ if(fp) fclose(fp); else printf("Cannot write %s!\n",Out);
+ printf("%lu games, %lu moves, %lu games with illegal moves, %lu entries written to %s (%.1lfs)\n",
+ 		B->Games,B->Moves,B->Errors,n,Out,WallTime()-t1);
+ for(j=0;j<=(B->N-1)>>16;j++) free(B->Blk[j]);
+ free(B->Head); free(B); free(S);
+}
 
-  Val=Pw-Pb+(short)((Gm->Count[0]).pawns-(Gm->Count[1]).pawns)*v[4];	// add pawn values
+void	InitBook()														// build sorted index of tree book
+{
+ Game	*GmTest;
+ Fbyte	i=0;
+ Dbyte	Mov;
+ Byte	t,f;
 
-  PM=Gm->POSITION[0][4]; if((PM&WS)&&(PM&BS)) Val+=Paras[10].Val; 		// pair of bishops bonus white 	
-  QM=Gm->POSITION[1][4]; if((QM&WS)&&(QM&BS)) Val-=Paras[10].Val; 		// pair of bishops bonus black
-  if((!(PM&(PM-1)))&&(!(QM&(QM-1)))&&((PM|QM)&WS)&&((PM|QM)&BS)) i=1; 	// single differently colored bishops
-  else i=0;	
-  
-  Pa=v[4]*((short)((Gm->Count[0]).pawns)-5); if(Pa<0) Pa=0;				// value of number of pawns above 5 for white	
-  PM=Gm->POSITION[0][5]; while(PM) {Val+=Pa/16; PM&=PM-1;}				// bonus for knights with pawns on the board 								
-  PM=Gm->POSITION[0][3]; while(PM) {Val-=Pa/8;  PM&=PM-1;}				// malus for rooks with pawns on the board					
-  Pa=v[4]*((short)((Gm->Count[1]).pawns)-5); if(Pa<0) Pa=0;				// value of number of pawns above 5 for white	
-  PM=Gm->POSITION[1][5]; while(PM) {Val-=Pa/16; PM&=PM-1;}				// bonus for knights with pawns on the board 								
-  PM=Gm->POSITION[1][3]; while(PM) {Val+=Pa/8;  PM&=PM-1;}				// malus for rooks with pawns on the board
+ GmTest=(Game*)malloc(sizeof(Game)); GetPosition(GmTest,Startpos);		// start from initial position
+ TreeIdx=(BitMap*)malloc(sizeof(Aob_tre)/2*sizeof(BitMap)); TreeN=0;	// at most one entry per move
+ while(Mov=Aob_tre[i++])												// replay database once
+  if((f=(Mov&0xFF))==(Mov>>8)) for(t=0;t<f;t++) UnMove(GmTest);		// end of opening line, take back f moves
+  else
+  {
+   if(!(Mov&64))														// record position and move
+    TreeIdx[TreeN++]=((GmTest->Moves[GmTest->Move_n]).HASH&0xFFFFFFFFFFFF0000)|Mov;
+   Move(GmTest,Mov&0xFFBF);												// make move
+  }
+ qsort(TreeIdx,TreeN,sizeof(BitMap),CompareKey);						// sort by position hash
+ free(GmTest);
+}
+
+Fbyte	BookFind(const BitMap* B, Fbyte N, BitMap K, Byte sh, Fbyte* n)	// first entry of position (hash bits above sh)
+{
+ Fbyte	lo=0,hi=N,m;
+
+ K>>=sh;
+ while(lo<hi) {m=(lo+hi)/2; if((B[m]>>sh)<K) lo=m+1; else hi=m;}		// binary search of first entry
+ for(*n=0;(lo+*n<N)&&((B[lo+*n]>>sh)==K);(*n)++);						// count moves of position
+ return lo;
+}
 
-  j=64;
+int		CompareKey(const void* a, const void* b)						// compare book keys for qsort
+{
+ BitMap	x=*(const BitMap*)a,y=*(const BitMap*)b;
  
-  if(Val>0)																// white is leading
+ return (x>y)-(x<y);
+}
+
+bool 	SEE(Game *Gm, Mvs *Mv, Dbyte Mov, short Thr)					// SEE of move larger or equal threshold?
+{
+ short	Val;
+ Byte 	f,t,p,i;
+#if defined(USE_ATTACKS)
+ BitMap OM;
+#endif
+
+ if(Mov&128) return true;												// promotion
+ t=(Byte)(Mov>>8)&63; f=(Byte)(Mov)&63;									// origin and destination
+ if(p=(Gm->Piece[1-Gm->color][t]).type)									// possible SEE gain is value of piece on destination
+ 	Val=PVAL(p); 			
+ else Val=0;
+ if(Val<Thr) return false;												// value of piece to gain is lower than threshold
+ if(Val-PVAL((Gm->Piece[Gm->color][f]).type)>=Thr) return true;			// even if piece is lost, move is worthwhile
+#if defined(USE_ATTACKS)
+ OM=STEP[3+Gm->color][t]&Gm->POSITION[1-Gm->color][6];					// attacking pawns
+ for(p=0;(!OM)&&(p<(Gm->Count[1-Gm->color]).officers);p++)				// officers attacking destination or ...
+  if(Gm->ATKF[i=(Gm->Officer[1-Gm->color][p]).square]&((A8<<t)|(A8<<f)))	// ... origin (x-ray behind moving piece)
+   OM=A8<<i;
+ if(!OM) return true;													// no attackers: gain is piece value
+#endif
+ for(i=0;i<Mv->sn;i++) if(Mv->SeeM[i]==Mov) return (Mv->SeeV[i]>=Thr);	// exchange value in SEE cache
+ Val=SeeValue(Gm,Mov);
+ i=Mv->sn<8?(Mv->sn)++:Mov&7;											// cache slot (replace if full)
+ Mv->SeeM[i]=Mov; Mv->SeeV[i]=Val;										// store exchange value
+ return (Val>=Thr);
+}
+
+short	SeeValue(Game *Gm, Dbyte Mov)									// static exchange value of move (swap list)
+{
+ short	G[32];
+ Byte 	f,t,c,p,d=0;
+ BitMap OC,AT,RQ,BQ,BM,XR;
+
+ t=(Byte)(Mov>>8)&63; f=(Byte)(Mov)&63;									// origin and destination
+ G[0]=(p=(Gm->Piece[1-Gm->color][t]).type)?PVAL(p):0;					// gain of first capture
+ RQ=Gm->POSITION[0][2]|Gm->POSITION[0][3]|Gm->POSITION[1][2]|Gm->POSITION[1][3];	// rooks and queens
+ BQ=Gm->POSITION[0][2]|Gm->POSITION[0][4]|Gm->POSITION[1][2]|Gm->POSITION[1][4];	// bishops and queens
+ OC=Gm->ROTATED[0]; AT=AttacksTo(Gm,0,t)|AttacksTo(Gm,1,t);				// occupancy, attackers and defenders
+ p=(Gm->Piece[Gm->color][f]).type; c=Gm->color; BM=A8<<f;				// moving piece
+ do
+ {
+  d++; G[d]=PVAL(p)-G[d-1];												// gain if piece on destination is captured
+  if(max(-G[d-1],G[d])<0) break;										// no side can improve by capturing
+  OC^=BM; AT&=OC;														// remove piece from occupancy and attackers
+  if((XR=XRAY[t][f]))													// x-ray: sliders behind removed piece
   {
-   if((!((Gm->Count[0]).pawns))&&(Pw-Pb<=v[2]))							// white has no pawns and is less than a bishop ahead
-    j=(Pw<v[1]) ? 0 : ((Pb<=v[2]) ? 4 : 14);							// scale factor for reduced material
-   else if(i&&((Gm->Count[0]).officers==2)&&
-   				((Gm->Count[1]).officers==2)) j=22;						// opposing bishops
-   else j=min(64,36+(i?2:7)*(Gm->Count[0]).pawns);						// scale factor for reduced material
+   if(!((t^f)&7)||!((t^f)&56)) AT|=PieceAttacks(Gm,0,3,f)&XR&RQ&OC;		// rook or queen on rank or file
+   else AT|=PieceAttacks(Gm,0,4,f)&XR&BQ&OC;							// bishop or queen on diagonal
   }
-  else if(Val<0)														// black is ahead
+  c=1-c; for(p=6;p&&!(BM=AT&Gm->POSITION[c][p]);p--);					// least valuable attacker of side
+  BM&=-BM; f=find_b[(BM^(BM-1))%67];									// one attacker, its square
+ }
+ while(p);
+ while(--d) G[d-1]=-max(-G[d-1],G[d]);									// negamax of swap list
+ return G[0];
+}
+
+short 	MatEval(Game* Gm)												// material+pst+stm evaluation
+{
+ Mat	M;
+ short	Val;
+ Byte	N[2][6],c,p,i;
+ float	d;
+
+ p=min(Gm->phase,24);													// game phase
+ 
+ if(Gm->Mexc||Gm->Trace) for(c=0;c<2;c++)								// piece counts
+ {
+  N[c][0]=Popcount(Gm->POSITION[c][2]); N[c][1]=Popcount(Gm->POSITION[c][3]);
+  N[c][2]=Popcount(Gm->POSITION[c][4]&WS); N[c][3]=Popcount(Gm->POSITION[c][4]&BS);
+  N[c][4]=Popcount(Gm->POSITION[c][5]); N[c][5]=(Gm->Count[c]).pawns;
+ }
+ if(!Gm->Mexc) M=mat_t[Gm->MKEY];										// direct-indexed material table entry
+ else MatEntry(N,p,&M);													// counts beyond table range
+ Val=M.Val;
+ 
+ if(Gm->Trace)															// piece values are tapered and scaled
+ {
+  for(i=0;i<5;i++)
   {
-   if((!((Gm->Count[1]).pawns))&&(Pb-Pw<=v[2]))							// black has no pawns and is less than a bishop ahead
-    j=(Pb<v[1]) ? 0 : ((Pw<=v[2]) ? 4 : 14);							// scale factor for reduced material
-   else if(i&&((Gm->Count[0]).officers==2)&&
-   				((Gm->Count[1]).officers==2)) j=22;						// opposing bishops
-   else j=min(64,36+(i?2:7)*(Gm->Count[1]).pawns);						// scale factor for reduced material
+   d=(i<2?N[0][i]-N[1][i]:(i==2?N[0][2]+N[0][3]-N[1][2]-N[1][3]:N[0][i+1]-N[1][i+1]))*M.Scale/128.0;
+   TRACE(O,5+i,d); TRACE(E,101+i,d);									// values are stored doubled
   }
-  
-  Val=(Val*(short)(j))/64;												// scaling the material value
-  LOCK=Val+(((Gm->MHASH>>16)^Val)<<16);									// calculate entry with Val as crc
-  *(BitMap*)(mhash_t+((Gm->MHASH)%MEN)*8)=LOCK;							// save entry
+  d=((N[0][4]/16.0-N[0][1]/8.0)*max(0,N[0][5]-5)-(N[1][4]/16.0-N[1][1]/8.0)*max(0,N[1][5]-5))*M.Scale/128.0;
+  TRACE(O,9,d); TRACE(E,105,d);											// knights and rooks with more than 5 pawns
+  d=((N[0][2]&&N[0][3])-(N[1][2]&&N[1][3]))*M.Scale/64.0;				// pair of bishops
+  TRACE(O,10,d); TRACE(E,10,d);
+  TRACE(O,11,((Gm->Psv[0]).Open-(Gm->Psv[1]).Open)/20.0); TRACE(E,11,((Gm->Psv[0]).End-(Gm->Psv[1]).End)/20.0);
  }
 
  Val+=(((((Gm->Psv[0]).Open-(Gm->Psv[1]).Open)*p+						// tempered piece square value for opening...
  	  ((Gm->Psv[0]).End-(Gm->Psv[1]).End)*(24-p))/48)*					// ... and endgame;
-	   Paras[11].Val)/10;												 
+	   PAR(11))/10;												 
 	   	   	   	  
  if(Gm->color) Val=-Val;												// stm is black 
   	  
@@ -2843,64 +4555,79 @@ void	DebugEval(Game* Gm)
 {
  Mvs	Mv;
  NNUE	Nn;
- Byte	i;
- short	v0,v1,v2,v3,v4,v5;
- Byte	*ekey,*pkey,*mkey;
+ Byte	gp=min(24,Gm->phase);
+ short	v0,v1;
+#if !defined(CONST_PARAS)
+ Ecoef	C[sizeof(Paras)/sizeof(Paras[0])];
+ Byte	i,k,n;
+ short	v5=0,Base;
+ float	c;
+#endif
   
- ekey=ehash_t+(((Gm->Moves[Gm->Move_n]).HASH)%EEN)*8;					// evaluation hash table entry address
- mkey=mhash_t+((Gm->MHASH)%MEN)*8;										// material hash table entry address
- pkey=phash_t+((Gm->PHASH)%PEN)*40; 									// pawn hash table entry address 
- 
- GenMoves(Gm,&Mv); if(Options[8].Val) NNUE_InitFeatures(Gm,&Nn,3);	    // generate moves and initialize NNUE (needed for eval)
- v0=Evaluation(Gm,&Nn,&Mv,-MaxScore,MaxScore); v1=MatEval(Gm); v5=0;	// evaluation with standard parameters
+ Mv.cp=NOMOVES; if(Options[8].Val) NNUE_InitFeatures(Gm,&Nn,3);			// moves on demand, initialize NNUE (needed for eval)
+ v0=Evaluation(Gm,&Nn,&Mv,-MaxScore,MaxScore); v1=MatEval(Gm);			// evaluation with standard parameters
  if(Gm->color) {v0=-v0; v1=-v1;}
- printf("info string Debug evaluation: %d \n",v0);
+ printf("info string Debug evaluation: %d (phase %d)\n",v0,gp);
+#if defined(CONST_PARAS)
+ printf("info string Parameters are compile-time constants in this build!\n");
+#else
+ n=EvalCoefficients(Gm,&Mv,C,&Base);									// linear coefficients of parameters
  printf("info string ------\n");
  	 
- for(i=0;i<sizeof(Paras)/sizeof(Paras[0]);i++) if(Paras[i].Change)		// parse changeable parameters
+ for(i=k=0;k<n;k++)														// parameters with influence
  { 
-  if(i==13) 
+  if((C[k].Par>12)&&!i) 
   {
    printf("info string ------\n");
    printf("info string Material, PST and side to move bonus: %d\n",v1);	
-   printf("info string ------\n");
-  }
-  v4=Paras[i].Val; 														// standard parameter
-  *(BitMap*)(ekey)=*(BitMap*)(pkey)=*(BitMap*)(mkey)=0; 				// reset hash tables
-  Paras[i].Val=Paras[i].Low;											// set parameter to lower limit
-  v2=Evaluation(Gm,&Nn,&Mv,-MaxScore,MaxScore);							// get evaluation with this parameter
-  *(BitMap*)(ekey)=*(BitMap*)(pkey)=*(BitMap*)(mkey)=0; 				// reset hash tables
-  Paras[i].Val=Paras[i].High;											// set parameter to upper limit
-  v3=Evaluation(Gm,&Nn,&Mv,-MaxScore,MaxScore); 						// get evaluation with this parameter
-  *(BitMap*)(ekey)=*(BitMap*)(pkey)=*(BitMap*)(mkey)=0;					// reset hash tables
-  Paras[i].Val=v4;														// set parameter to original value
-  if(Gm->color) {v2=-v2; v3=-v3;}
-  if((v2!=v0)||(v3!=v0))
-  {
-   if(i>12) v5+=v0-v2;
-   printf("info string %21s (current: %4d): %5d possible (max: %4d): %4d \n",// show name and influence of parameter ...
-    Paras[i].Name,v4,v0-v2,Paras[i].High,v3-v0);						// ... on evaluation
+   printf("info string ------\n"); i=1;
   }
+  c=(C[k].Op*gp+C[k].Eg*(24-gp))/24; if(Gm->color) c=-c;				// tapered coefficient for white
+  if(C[k].Par>12) v5+=(short)lround(c*(C[k].Ref-Paras[C[k].Par].Low));
+  printf("info string %21s (current: %4d): %5ld possible (max: %4d): %4ld  op %6.2f eg %6.2f\n",// show name and influence of parameter ...
+   Paras[C[k].Par].Name,C[k].Ref,lround(c*(C[k].Ref-Paras[C[k].Par].Low)),// ... on evaluation
+   Paras[C[k].Par].High,lround(c*(Paras[C[k].Par].High-C[k].Ref)),C[k].Op,C[k].Eg);
  }
  printf("info string ------\n");
  printf("info string Sum of positional factors: %d\n",v5);
+#endif
+}
+
+#if !defined(CONST_PARAS)
+Byte	EvalCoefficients(Game* Gm, Mvs* Mv, Ecoef* C, short* Base)		// linear coefficients of evaluation parameters
+{
+ NNUE	Nn;
+ Etrace	Tr;
+ Byte	i,n=0;
+ float	s=Gm->color?-1:1,f=(100-(Gm->Moves[Gm->Move_n]).fifty)/100.0;	// stm view, 50-move reduction
+
+ memset(&Tr,0,sizeof(Tr)); Gm->Trace=&Tr;								// classical evaluation without hash entries ...
+ *Base=Evaluation(Gm,&Nn,Mv,-MaxScore,MaxScore); Gm->Trace=NULL;		// ... records the terms of all parameters
+ for(i=0;i<sizeof(Paras)/sizeof(Paras[0]);i++) 							// changeable parameters with influence
+  if(Paras[i].Change&&(Tr.O[i]||Tr.E[i]||Tr.V[i]))
+  {
+   C[n].Par=i; C[n].Ref=Paras[i].Val;
+   C[n].Op=(s*Tr.O[i]+Tr.V[i])*f; C[n++].Eg=(s*Tr.E[i]+Tr.V[i])*f;
+  }
+ return n;
 }
+#endif
 
 short	Evaluation(Game* Gm, NNUE* Nn,  Mvs* Mv, short Alpha, short Beta)// evaluation
 {
- BitMap ELOCK,EHASH,PLOCK[5],PP[2],AP[2],PAI,PAB,PAD,PAP,PAC,PAW,PCH,PPH,CM;
- BitMap	KM,PS,NM,MM,MP[5],PM,PN,PO;
+ BitMap ELOCK,EHASH,PLOCK[4],PP[2],AP[2],PAI,PAB,PAD,PAP,PAC,PAW,PCH,PPH,CM;
+ BitMap	KM,PS,NM,MM,MP[5],PM,PN,PO,S1,S2,H1,H2;
  short	Val,Oval,Eval,Dval,cl,p,Val2;
- Byte	pk[2],gp,flg,co,sp;
+ Byte	pk[2],gp,flg,co,sp,e;
  Byte	*ekey,*pkey;
  
  //return MatEval(Gm);
 
  EHASH=(Gm->Moves[Gm->Move_n]).HASH; ekey=ehash_t+(EHASH%EEN)*8;		// evaluation hash table entry address
  ELOCK=*(BitMap*)(ekey); Val=(short)(ELOCK);							// evaluation is in the first two bytes
- if(((ELOCK^EHASH)>>16)==(BitMap)(Val)&0xFFFF) goto EVAL_END;			// evaluation found in hash table
+ if(!Gm->Trace&&(((ELOCK^EHASH)>>16)==((BitMap)(Val)&0xFFFF))) goto EVAL_END;	// evaluation found in hash table
  
- if(Options[8].Val) {Val=NNUE_Evaluate(Gm,Nn); goto STORE_EVAL;}		// return NNUE evaluation
+ if(Options[8].Val&&!Gm->Trace) {Val=NNUE_Evaluate(Gm,Nn); goto STORE_EVAL;}	// return NNUE evaluation
  
  gp=min(24,Gm->phase);													// game phase 0 (endgame) to 24 (opening)
  Val=MatEval(Gm); 														// material evaluation
@@ -2908,39 +4635,35 @@ short	Evaluation(Game* Gm, NNUE* Nn,  Mvs* Mv, short Alpha, short Beta)// evalua
  PP[0]=Gm->POSITION[0][6]; PP[1]=Gm->POSITION[1][6];					// pawn positions
  pk[0]=(Gm->Officer[0][0]).square; pk[1]=(Gm->Officer[1][0]).square;	// king positions
 
- pkey=phash_t+(Gm->PHASH%PEN)*40; 										// pawn hash key and weak pawns
- PLOCK[0]=*(BitMap*)(pkey); 	  PLOCK[1]=*(BitMap*)(pkey+8); 			// lock 0..3
- PLOCK[2]=*(BitMap*)(pkey+16); 	  PLOCK[3]=*(BitMap*)(pkey+24); 		// 
- PLOCK[4]=*(BitMap*)(pkey+32);
+ AP[0]=((PA&PP[0])>>9)|((PH&PP[0])>>7);									// white's pawn attacks
+ AP[1]=((PA&PP[1])<<7)|((PH&PP[1])<<9);									// black's pawn attacks
+
+ pkey=phash_t+(Gm->PHASH%PEN)*64; 										// pawn hash bucket of two 32 byte entries
+ for(e=Gm->Trace?64:0;e<64;e+=32)										// trace evaluates pawns without hash entry
+ {
+  PLOCK[0]=*(BitMap*)(pkey+e);	  PLOCK[1]=*(BitMap*)(pkey+e+8); 		// lock and entry
+  PLOCK[2]=*(BitMap*)(pkey+e+16); PLOCK[3]=*(BitMap*)(pkey+e+24);
+  if(!(Gm->PHASH^PLOCK[0]^PLOCK[1]^PLOCK[2]^PLOCK[3])) 	break;			// entry fits and crc is right
+ }
  
- if(Gm->PHASH^PLOCK[0]^PLOCK[1]^PLOCK[2]^PLOCK[3]^PLOCK[4])				// entry or crc wrong
+ if(e==64)																// no entry fits
  {
   Oval=Eval=0; PAI=PAB=PAD=PAP=PAC=PAW=PCH=PPH=0;	flg=0;				// intialize values and pawn bitmaps
 	
-  for(CM=H;CM>A1;CM>>=1) for(co=0;co<2;co++)							// scan files H to A and colors
+  for(co=0;co<2;co++)													// set-wise pawn structure of each color
   {
-   KM=CM&PP[co]; if(KM&(KM-1)) 							PAD|=KM;		// multiple pawns -> register in double pawn bitmap
-   while(KM)															// all pawns on this file
-   {
-    sp=find_b[(KM^KM-1)%67]; PS=KM&(-KM); KM-=PS; NM=0;   				// sp=pawn square, ps=bitmap of this pawn, remove from file									
-    
-	if((!(PAWN_E[co][1][sp]&PP[1-co]))&&								// check front and side spawns
-       (!(PAWN_E[co][0][sp]&PP[co]))) 					PAP|=PS;		// register passed pawn (no double passed pawn!)
-    if( !(PAWN_E[co][4][sp]&PP[co])) 	 				PAI|=PS;		// register isolated pawn 
-    if(!((MM=PAWN_E[0][7][sp])&PP[co])) while(MM)						// test for weak pawn. no neighbouring pawns of same color
-    {
-     if(co) MM>>=8; else MM<<=8;										// next row
-     if(!MM) break;														// off the board
-     if(MM&PP[co]) {NM=0; break;}										// pawn of same color									
-	 if(MM&PP[1-co]) {NM=PS; MM-=(MM&PP[1-co]);}						// pawn of opposite color
-	}													PAW|=NM;		// register weak pawn
-    if((!(PAWN_E[co][3][sp]&PP[co]))&&									// no friendly pawns on neighbour files and
-	   (!(PAWN_E[co][0][sp]&(PP[co]|PP[1-co])))&&						// no pawns in front			
-       (PP[1-co]&STEP[3+co][sp-8+16*co])) 				PAB|=PS;		// front square controlled by enemy pawn -> register backward pawn
-    MM=PAWN_E[co][6][sp]&PP[1-co]; NM=PAWN_E[co][3][sp]&PP[co];			// sentries and helpers
-    if((!(PAWN_E[co][0][sp]&PP[1-co]))&&MM&&NM&&						// no blocking pawn and at least one sentry and helper
-      ((!(MM&(MM-1))||(NM&(NM-1)))))  					PAC|=PS;		// at most 1 sentry or two helpers: candidate
-   }
+   PM=PP[co]; PN=PP[1-co]; PO=~(PM|PN);									// own, opponent pawns and empty squares
+   S1=Spawn(PN,1-co); S2=Spawn(PN&S1,1-co);								// at least one/two opponent pawns in front
+   H1=PM|Spawn(PM,co); H2=PM&Spawn(PM,co); H2|=Spawn(H2,co);			// at least one/two own pawns on or behind
+   KM=Spawn(PM,0)|Spawn(PM,1);											// files of own pawns
+   PAD|=PM&KM;															// double pawns
+   PAI|=PM&~Sides(PM|KM);												// isolated pawns: no own pawns on neighbour files
+   PAP|=PM&~(S1|Sides(S1)|Spawn(PM,1-co));								// passed pawns: front and side spawns free (no double passed pawn!)
+   MM=SpawnStop(PM,PO,co); NM=SpawnStop(PN,PO,co);						// first pawn behind on a file is own/opponent
+   PAW|=PM&~Sides(PM)&Sides(NM)&~Sides(MM);								// weak pawns: no neighbour on rank, behind only opponent pawns come first
+   PAB|=PM&~Sides(H1)&~Spawn(PM|PN,1-co)&(co?AP[0]>>8:AP[1]<<8);		// backward pawns: front square controlled by enemy pawn
+   PAC|=PM&~S1&Sides(S1)&Sides(H1)&										// candidates: sentries and helpers, no blocking pawn ...
+   		(~(Sides(S2)|BothSides(S1))|Sides(H2)|BothSides(H1));			// ... at most 1 sentry or two helpers
   }
   PAW&=~PAI;															// isolated pawns already get malus
   
@@ -2956,35 +4679,45 @@ short	Evaluation(Game* Gm, NNUE* Nn,  Mvs* Mv, short Alpha, short Beta)// evalua
    PS=PP[co]; cl=1-2*co; while(PS)										// positions of pawns
    {
     sp=find_b[(PS^PS-1)%67]-8*cl;										// square in front of pawn
-    Eval+=Paras[13].Val*cl*Dist[pk[1-co]][sp];							// distance of opponent king 
-    Eval-=Paras[13].Val*cl*Dist[pk[co]][sp];							// distance of friendly king
+    Eval+=PAR(13)*cl*Dist[pk[1-co]][sp];								// distance of opponent king 
+    Eval-=PAR(13)*cl*Dist[pk[co]][sp];									// distance of friendly king
+    TRACE(E,13,cl*(Dist[pk[1-co]][sp]-Dist[pk[co]][sp]));
     PS&=PS-1;															// next pawn
    }
-   Dval=Popcount(PCH&PP[co])*Paras[14].Val*cl; Oval+=Dval; Eval+=Dval;	// pawn chains
-   Dval=Popcount(PPH&PP[co])*Paras[15].Val*cl; Oval+=Dval; Eval+=Dval;	// pawn phalanx
+   Dval=Popcount(PCH&PP[co])*cl; TRACE(O,14,Dval); TRACE(E,14,Dval);
+   Dval*=PAR(14); Oval+=Dval; Eval+=Dval;								// pawn chains
+   Dval=Popcount(PPH&PP[co])*cl; TRACE(O,15,Dval); TRACE(E,15,Dval);
+   Dval*=PAR(15); Oval+=Dval; Eval+=Dval;								// pawn phalanx
   }
   for(co=0;co<2;co++)													// evaluate pawn structure
   {
    cl=1-2*co; 
-   PS=PP[co]&PAD;														// double pawns 
-   while(PS) {Oval-=Paras[16].Val*cl; Eval-=Paras[17].Val*cl; PS&=PS-1;}// opening and endgame malus
+   PS=PP[co]&PAD;														// double pawns
+   TRACE(O,16,-cl*Popcount(PS)); TRACE(E,17,-cl*Popcount(PS));
+   while(PS) {Oval-=PAR(16)*cl; Eval-=PAR(17)*cl; PS&=PS-1;}			// opening and endgame malus
    PS=PP[co]&PAI;														// isolated pawns
-   while(PS) {Oval-=Paras[18].Val*cl; Eval-=Paras[19].Val*cl; PS&=PS-1;}// opening and endgame malus
+   TRACE(O,18,-cl*Popcount(PS)); TRACE(E,19,-cl*Popcount(PS));
+   while(PS) {Oval-=PAR(18)*cl; Eval-=PAR(19)*cl; PS&=PS-1;}			// opening and endgame malus
    PS=PP[co]&PAB;														// backward pawns
-   while(PS) {Oval-=Paras[20].Val*cl; Eval-=Paras[21].Val*cl; PS&=PS-1;}// opening and endgame malus
+   TRACE(O,20,-cl*Popcount(PS)); TRACE(E,21,-cl*Popcount(PS));
+   while(PS) {Oval-=PAR(20)*cl; Eval-=PAR(21)*cl; PS&=PS-1;}			// opening and endgame malus
    PS=PP[co]&PAW;														// weak pawns
-   while(PS) {Oval-=Paras[22].Val*cl; Eval-=Paras[23].Val*cl; PS&=PS-1;}// opening and endgame malus
+   TRACE(O,22,-cl*Popcount(PS)); TRACE(E,23,-cl*Popcount(PS));
+   while(PS) {Oval-=PAR(22)*cl; Eval-=PAR(23)*cl; PS&=PS-1;}			// opening and endgame malus
  
    CM=PS=PP[co]&PAP;													// passed pawns
     
    while(PS)															// parse passed pawns
    {
     sp=find_b[(PS^PS-1)%67];											// square of pawn
-    Eval+=Paras[24].Val*cl*(2*Dist[pk[1-co]][sp+16*co-8]-
+    Eval+=PAR(24)*cl*(2*Dist[pk[1-co]][sp+16*co-8]-
 										Dist[pk[co]][sp+16*co-8]);		// distance to kings
+    TRACE(E,24,cl*(2*Dist[pk[1-co]][sp+16*co-8]-Dist[pk[co]][sp+16*co-8]));
     if(co) Dval=(sp>>3); else Dval=7-(sp>>3); Dval*=Dval; 				// rank of passed pawn
-	Oval+=Paras[25].Val*Dval*cl; Eval+=Paras[26].Val*Dval*cl;			// general opening and endgame bonus			
-    if(PAWN_E[co][4][sp]&CM) Eval+=Paras[27].Val*Dval*cl/8;				// connected passed pawn
+	Oval+=PAR(25)*Dval*cl; Eval+=PAR(26)*Dval*cl;						// general opening and endgame bonus
+	TRACE(O,25,Dval*cl); TRACE(E,26,Dval*cl);
+    if(PAWN_E[co][4][sp]&CM)											// connected passed pawn
+     {Eval+=PAR(27)*Dval*cl/8; TRACE(E,27,Dval*cl/8.0);}
 	PS&=PS-1;															// next pawn
    }
 
@@ -2992,23 +4725,25 @@ short	Evaluation(Game* Gm, NNUE* Nn,  Mvs* Mv, short Alpha, short Beta)// evalua
    while(PS)
    {
     sp=find_b[(PS^PS-1)%67];											// square of pawn
-    Eval+=Paras[28].Val*cl*(2*Dist[pk[1-co]][sp+16*co-8]-
+    Eval+=PAR(28)*cl*(2*Dist[pk[1-co]][sp+16*co-8]-
 										Dist[pk[co]][sp+16*co-8]);		// distance to kings
+    TRACE(E,28,cl*(2*Dist[pk[1-co]][sp+16*co-8]-Dist[pk[co]][sp+16*co-8]));
     if(co) Dval=(sp>>3); else Dval=7-(sp>>3); Dval*=Dval;				// rank of candidate pawn
-	Oval+=Paras[29].Val*Dval*cl; Eval+=Paras[30].Val*Dval*cl;	  		// opening and endgame bonus
+	Oval+=PAR(29)*Dval*cl; Eval+=PAR(30)*Dval*cl;						// opening and endgame bonus
+	TRACE(O,29,Dval*cl); TRACE(E,30,Dval*cl);
     PS&=PS-1;															// next pawn
    }
   }
    
-  AP[0]=((PA&PP[0])>>9)|((PH&PP[0])>>7);								// white's pawn attacks
-  AP[1]=((PA&PP[1])<<7)|((PH&PP[1])<<9);								// black's pawn attacks
-  												
   // king evaluation
   
-  Oval-=Paras[31].Val*(3-Popcount(STEP[8][pk[0]]&PP[0]));				// pawn shield white
-  Oval+=Paras[31].Val*(3-Popcount(STEP[9][pk[1]]&PP[1]));				// pawn shield black
-  Oval+=Paras[55].Val*(Popcount(AP[0]&STEP[1][pk[1]])-					// white pawns attacking black king 1 area
+  Oval-=PAR(31)*(3-Popcount(STEP[8][pk[0]]&PP[0]));						// pawn shield white
+  TRACE(O,31,Popcount(STEP[8][pk[0]]&PP[0])-3);
+  Oval+=PAR(31)*(3-Popcount(STEP[9][pk[1]]&PP[1]));						// pawn shield black
+  TRACE(O,31,3-Popcount(STEP[9][pk[1]]&PP[1]));
+  Oval+=PAR(55)*(Popcount(AP[0]&STEP[1][pk[1]])-						// white pawns attacking black king 1 area
  					   Popcount(AP[1]&STEP[1][pk[0]]));					// black pawns attacking white king 1 area
+  TRACE(O,55,Popcount(AP[0]&STEP[1][pk[1]])-Popcount(AP[1]&STEP[1][pk[0]]));
    
   if(((pk[0]&7)==(pk[1]&7))&&((pk[0]-pk[1]==16)||(pk[1]-pk[0]==16)))	// vertical opposition
   	  															flg|=1;	
@@ -3018,26 +4753,26 @@ short	Evaluation(Game* Gm, NNUE* Nn,  Mvs* Mv, short Alpha, short Beta)// evalua
   
   PAW|=(PAI|PAB|PAD);													// weak pawns: isolated,backward,double
 
-  PLOCK[1]=AP[0]|((BitMap)(Oval)<<48); 
-  PLOCK[2]=AP[1]|((BitMap)(Eval)&0xFFFF);								// construct pawn hash entry 
-  PLOCK[3]=PAP|((BitMap)(flg)&0xFF); PLOCK[4]=PAW;						// save weak pawns						
-  *(BitMap*)(pkey)=Gm->PHASH^PLOCK[1]^PLOCK[2]^PLOCK[3]^PLOCK[4];		// save lock with crc
+  PLOCK[1]=PAP|((BitMap)(flg)&0xFF); PLOCK[2]=PAW;						// construct pawn hash entry
+  PLOCK[3]=((BitMap)(Oval)&0xFFFF)|(((BitMap)(Eval)&0xFFFF)<<16);		// evaluations
+  memcpy(pkey+32,pkey,32);												// older entry to second slot
+  *(BitMap*)(pkey)=Gm->PHASH^PLOCK[1]^PLOCK[2]^PLOCK[3];				// save lock with crc
   *(BitMap*)(pkey+8)=PLOCK[1]; *(BitMap*)(pkey+16)=PLOCK[2];			// save hash entry
-  *(BitMap*)(pkey+24)=PLOCK[3]; *(BitMap*)(pkey+32)=PLOCK[4];
+  *(BitMap*)(pkey+24)=PLOCK[3];
  }
  else																	// pawn hash entry fits
  {
-  Oval=(short)(PLOCK[1]>>48); Eval=(short)(PLOCK[2]&0xFFFF); 			// evaluations and flags
-  flg=(Byte)(PLOCK[3]); PAP=PLOCK[3]&0x00FFFFFFFFFFFF00;				// flags and passed pawns
-  AP[0]=PLOCK[1]&0x0000FFFFFFFFFFFF; AP[1]=PLOCK[2]&0xFFFFFFFFFFFF0000;	// pawn attacks
-  PAW=PLOCK[4]&0x00FFFFFFFFFFFF00;										// weak pawns
+  Oval=(short)(PLOCK[3]); Eval=(short)(PLOCK[3]>>16); 					// evaluations
+  flg=(Byte)(PLOCK[1]); PAP=PLOCK[1]&0x00FFFFFFFFFFFF00;				// flags and passed pawns
+  PAW=PLOCK[2]&0x00FFFFFFFFFFFF00;										// weak pawns
  }
 
  // rest of pawn evaluation depending on other pieces
  
  CM=~Gm->POSITION[1-Gm->color][0]; NM=~Gm->POSITION[Gm->color][0];		// squares free of opponent's and stm's pieces
  MP[0]=MP[1]=MP[2]=MP[3]=MP[4]=0;										// initialize stm mvs by piece
- for(co=0;co<(Gm->Count[Gm->color]).officers;co++)						// parse alle stm officers 
+ if(PAP&&(Mv->cp==NOMOVES)) GenMoves(Gm,Mv);							// passed pawns need attacks: generate moves now
+ if(Mv->cp!=NOMOVES) for(co=0;co<(Gm->Count[Gm->color]).officers;co++)	// parse alle stm officers
   MP[(Gm->Officer[Gm->color][co]).type-1]|=Mv->OFFM[co];				// stm moves by piece
 
  if(PAP) for(co=0;co<2;co++)											// passed pawns evaluation
@@ -3050,13 +4785,15 @@ short	Evaluation(Game* Gm, NNUE* Nn,  Mvs* Mv, short Alpha, short Beta)// evalua
    sp=find_b[(PS^PS-1)%67];	PM=A8<<(sp+16*co-8);						// square and stop square of pawn
    if(co) Dval=(sp>>3); else Dval=7-(sp>>3);							// rank of passed pawn
    if(PAWN_E[co][0][sp]&Gm->POSITION[1-co][0])							// opponent piece in front
-    {Eval-=Paras[32].Val*cl; if(PM&Gm->POSITION[1-co][0]) Eval-=Paras[33].Val*cl;}	// malus for stop/telestop 
+    {Eval-=PAR(32)*cl; TRACE(E,32,-cl);									// malus for stop/telestop
+     if(PM&Gm->POSITION[1-co][0]) {Eval-=PAR(33)*cl; TRACE(E,33,-cl);}}
    else if(!(PAWN_E[co][2][sp+p]&Gm->POSITION[1-co][1]))				// opponent king not in Berger's square
-   	if((Gm->Count[1-co]).officers<2)	Eval+=Dval*Paras[34].Val*cl;	// race bonus
+   	if((Gm->Count[1-co]).officers<2)									// race bonus
+	 {Eval+=Dval*PAR(34)*cl; TRACE(E,34,Dval*cl);}
 	else if(((Gm->Count[1-co]).officers<3)&&(!(PAWN_E[co][0][sp]&KM))) 		
-										Eval+=Paras[35].Val*cl;			// bonus for free path outside berger
-   if(PAWN_E[co][0][sp]&KM) 			Eval-=Paras[36].Val*cl;			// malus for stop-square attacked	
-   if(PM&MM) 							Eval-=Paras[37].Val*cl;			// bishop controls stop square  
+							{Eval+=PAR(35)*cl; TRACE(E,35,cl);}			// bonus for free path outside berger
+   if(PAWN_E[co][0][sp]&KM)	{Eval-=PAR(36)*cl; TRACE(E,36,-cl);}		// malus for stop-square attacked
+   if(PM&MM)	{Eval-=PAR(37)*cl; TRACE(E,37,-cl);}					// bishop controls stop square
    PS&=PS-1;															// next pawn	 
   } 
  }
@@ -3064,15 +4801,22 @@ short	Evaluation(Game* Gm, NNUE* Nn,  Mvs* Mv, short Alpha, short Beta)// evalua
  cl=1-2*Gm->color;
  if(((Gm->Count[0]).officers+(Gm->Count[1]).officers==2)&&				// no officers ...
  	((Gm->Count[0]).pawns+(Gm->Count[0]).pawns))						// but pawns
-  if(flg&1) 							Eval+=Paras[38].Val*cl;			// vertical opposition bonus depends on stm										
-  else if(flg&2) 						Eval+=Paras[39].Val*cl;			// horizontal opposition bonus depends on stm						
+  if(flg&1)	{Eval+=PAR(38)*cl; TRACE(E,38,cl);}							// vertical opposition bonus depends on stm
+  else if(flg&2)	{Eval+=PAR(39)*cl; TRACE(E,39,cl);}					// horizontal opposition bonus depends on stm
   
  Dval=(Oval*gp+Eval*(24-gp))/24;										// tapered evaluation
 
  if(Gm->color) Val-=Dval; else Val+=Dval;								// evaluation 
 
- if(Paras[40].Val&&((Val+Paras[40].Val<Alpha)||							// lazy eval
- 	(Val-Paras[40].Val>Beta))) goto STORE_EVAL;
+ if(PAR(40)&&((Val+PAR(40)<Alpha)||										// lazy eval
+ 	(Val-PAR(40)>Beta))) goto STORE_EVAL;
+ 
+ if(Mv->cp==NOMOVES)													// moves not generated yet
+ {
+  GenMoves(Gm,Mv);														// mobility and attacks need moves
+  for(co=0;co<(Gm->Count[Gm->color]).officers;co++)						// parse alle stm officers
+   MP[(Gm->Officer[Gm->color][co]).type-1]|=Mv->OFFM[co];				// stm moves by piece
+ }
  
  // Mobility and attacks
  
@@ -3083,92 +4827,103 @@ short	Evaluation(Game* Gm, NNUE* Nn,  Mvs* Mv, short Alpha, short Beta)// evalua
     	(PP[1-Gm->color]&(~AP[1-Gm->color]));							// and undefended pawns
 
  NM=(~PP[0])&(~PP[1]); PS=Mv->PINO&NM; PO=Mv->PINS&NM;					// opponent's and stm's pinned officers
- Val+=Paras[41].Val*(Popcount(PS)-Popcount(PO));						// malus for pinned officers 
+ Val+=PAR(41)*(Popcount(PS)-Popcount(PO));								// malus for pinned officers
+ TRACE(V,41,Popcount(PS)-Popcount(PO));
 
  NM&=Mv->DCHK; 															// discovered check officers
  PS=NM&Gm->POSITION[Gm->color][0]; PO=NM&Gm->POSITION[1-Gm->color][0];
- Val+=Paras[42].Val*(Popcount(PS)-Popcount(PO));						// bonus for discovered check officers
+ Val+=PAR(42)*(Popcount(PS)-Popcount(PO));								// bonus for discovered check officers
+ TRACE(V,42,Popcount(PS)-Popcount(PO));
  
- Val+=Paras[99].Val*(Popcount(PN&(Mv->ADES)&(~Mv->OATK[0])&(~AP[1-Gm->color]))-	// hanging oponent's pieces
+ Val+=PAR(99)*(Popcount(PN&(Mv->ADES)&(~Mv->OATK[0])&(~AP[1-Gm->color]))-		// hanging oponent's pieces
  		  			 Popcount(PM&(Mv->OATK[0])&(~Mv->ADES)));			// hanging own pieces
+ TRACE(V,99,Popcount(PN&(Mv->ADES)&(~Mv->OATK[0])&(~AP[1-Gm->color]))-Popcount(PM&(Mv->OATK[0])&(~Mv->ADES)));
  
  if(!((Mv->cp)&192)) for(co=1;co<5;co++)								// walk thru moves by piece (no kings or pawns, no check)
  {	
   PPH=MP[co]; PCH=Mv->OATK[co+1]&CM;									// moves by stm and opponent officers 
-  Val+=Paras[43].Val*(Popcount(PPH&PN)-Popcount(PCH&PM));				// bonus for officers attacking pieces
-  Val+=Paras[44].Val*(Popcount(PPH&KM)-Popcount(PCH&MM));				// bonus for attacks on dist-1 king area
-  Val+=Paras[45].Val*(Popcount(PPH&PAW&PP[1-Gm->color])-				// bonus for attacks on weak pawns
+  Val+=PAR(43)*(Popcount(PPH&PN)-Popcount(PCH&PM));						// bonus for officers attacking pieces
+  TRACE(V,43,Popcount(PPH&PN)-Popcount(PCH&PM));
+  Val+=PAR(44)*(Popcount(PPH&KM)-Popcount(PCH&MM));						// bonus for attacks on dist-1 king area
+  TRACE(V,44,Popcount(PPH&KM)-Popcount(PCH&MM));
+  Val+=PAR(45)*(Popcount(PPH&PAW&PP[1-Gm->color])-						// bonus for attacks on weak pawns
   		  Popcount(PCH&PAW&PP[Gm->color])); 
+  TRACE(V,45,Popcount(PPH&PAW&PP[1-Gm->color])-Popcount(PCH&PAW&PP[Gm->color]));
 
   switch(co)
   {
   	case 1: if(Gm->POSITION[Gm->color][2])								// stm queens exist
 	  		{
 			 Dval=Popcount(PPH&(~Mv->OATK[0])&(~AP[1-Gm->color]));		// count moves free of attacks
-	  		 Val+=Paras[46].Val*Dval; 									// queen mobility
-			 if(Dval<3) Val-=Paras[47].Val*(3-Dval);					// malus for trapped queen
+	  		 Val+=PAR(46)*Dval; TRACE(V,46,Dval);						// queen mobility
+			 if(Dval<3) {Val-=PAR(47)*(3-Dval); TRACE(V,47,Dval-3);}	// malus for trapped queen
 	  		}
 	  		if(Gm->POSITION[1-Gm->color][2])							// opponent queens exist
 			{
 			 Dval=Popcount(PCH&(~Mv->ADES)&(~AP[Gm->color]));			// count moves free of attacks
-	  		 Val-=Paras[46].Val*Dval; 									// queen mobility
-			 if(Dval<3) Val+=Paras[47].Val*(3-Dval);					// bonus for trapped queen
+	  		 Val-=PAR(46)*Dval; TRACE(V,46,-Dval);						// queen mobility
+			 if(Dval<3) {Val+=PAR(47)*(3-Dval); TRACE(V,47,3-Dval);}	// bonus for trapped queen
 		    }
  			break;
  	case 2: if(Gm->POSITION[Gm->color][3])								// stm rooks exist
  			{
  			 Dval=Popcount(PPH&(~AP[1-Gm->color]));						// count moves free of pawn attacks
- 			 Val+=Paras[48].Val*Dval; 									// rook mobility
-			 if(Dval<3) Val-=Paras[49].Val*(3-Dval);					// malus for trapped rook
+ 			 Val+=PAR(48)*Dval; TRACE(V,48,Dval);						// rook mobility
+			 if(Dval<3) {Val-=PAR(49)*(3-Dval); TRACE(V,49,Dval-3);}	// malus for trapped rook
  		    }
 	        if(Gm->POSITION[1-Gm->color][3])							// opponent rooks exist
 	        {
   			 Dval=Popcount(PCH&(~AP[Gm->color]));						// count moves free of pawn attacks
-  			 Val-=Paras[48].Val*Dval; 									// rook mobility
-			 if(Dval<3) Val+=Paras[49].Val*(3-Dval); 					// bonus for trapped rook
+  			 Val-=PAR(48)*Dval; TRACE(V,48,-Dval);						// rook mobility
+			 if(Dval<3) {Val+=PAR(49)*(3-Dval); TRACE(V,49,3-Dval);}	// bonus for trapped rook
 			}
   			break;
   	case 3: if(Gm->POSITION[Gm->color][4]&WS)							// stm bishop on white squares exists
 	  		{
-			 Val+=Paras[50].Val*(Dval=Popcount(PPH&(~AP[1-Gm->color])&WS));// count moves free of pawn attacks
-  			 if(Dval<3) Val-=Paras[51].Val*(3-Dval);					// malus for trapped bishop
+			 Val+=PAR(50)*(Dval=Popcount(PPH&(~AP[1-Gm->color])&WS));	// count moves free of pawn attacks
+			 TRACE(V,50,Dval);
+  			 if(Dval<3) {Val-=PAR(51)*(3-Dval); TRACE(V,51,Dval-3);}	// malus for trapped bishop
   		    }
 			if(Gm->POSITION[Gm->color][4]&BS)							// stm bishop on black squares exists
 	  		{
-  			 Val+=Paras[50].Val*(Dval=Popcount(PPH&(~AP[1-Gm->color])&BS));// count moves free of pawn attacks
-  			 if(Dval<3) Val-=Paras[51].Val*(3-Dval);					// malus for trapped bishop
+  			 Val+=PAR(50)*(Dval=Popcount(PPH&(~AP[1-Gm->color])&BS));	// count moves free of pawn attacks
+  			 TRACE(V,50,Dval);
+  			 if(Dval<3) {Val-=PAR(51)*(3-Dval); TRACE(V,51,Dval-3);}	// malus for trapped bishop
   		    }
   		    if(Gm->POSITION[1-Gm->color][4]&WS)							// opponent bishop on white squares exists
 	  		{
-  			 Val-=Paras[50].Val*(Dval=Popcount(PCH&(~AP[Gm->color])&WS));// count moves free of pawn attacks
-  			 if(Dval<3) Val+=Paras[51].Val*(3-Dval);					// bonus for trapped bishop
+  			 Val-=PAR(50)*(Dval=Popcount(PCH&(~AP[Gm->color])&WS));		// count moves free of pawn attacks
+  			 TRACE(V,50,-Dval);
+  			 if(Dval<3) {Val+=PAR(51)*(3-Dval); TRACE(V,51,3-Dval);}	// bonus for trapped bishop
   		    }
   		    if(Gm->POSITION[1-Gm->color][4]&BS)							// opponent bishop on black squares exists
 	  		{
-			 Val-=Paras[50].Val*(Dval=Popcount(PCH&(~AP[Gm->color])&BS));// count moves free of pawn attacks
-  			 if(Dval<3) Val+=Paras[51].Val*(3-Dval);					// bonus for trapped bishop
+			 Val-=PAR(50)*(Dval=Popcount(PCH&(~AP[Gm->color])&BS));		// count moves free of pawn attacks
+			 TRACE(V,50,-Dval);
+  			 if(Dval<3) {Val+=PAR(51)*(3-Dval); TRACE(V,51,3-Dval);}	// bonus for trapped bishop
 		    }
   			break;
   	case 4: if(PS=Gm->POSITION[Gm->color][5]) while(PS)					// stm knights exist
 	  		{
 	  		 sp=find_b[(PS^PS-1)%67]; PS&=PS-1;							// stm knight's position
 			 Dval=Popcount(PPH&STEP[2][sp]&(~AP[1-Gm->color]));			// count moves free of pawn attacks
-			 Val+=Paras[52].Val*Dval;									// knight mobility 
-			 if(Dval<2) Val-=Paras[53].Val*(2-Dval);					// malus for trapped knight	
+			 Val+=PAR(52)*Dval; TRACE(V,52,Dval);						// knight mobility
+			 if(Dval<2) {Val-=PAR(53)*(2-Dval); TRACE(V,53,Dval-2);}	// malus for trapped knight
 			}
 	  		if(PS=Gm->POSITION[1-Gm->color][5]) while(PS)				// opponent knights exist
   			{
 	  		 sp=find_b[(PS^PS-1)%67]; PS&=PS-1;							// opponent knight's position
 			 Dval=Popcount(PCH&STEP[2][sp]&(~AP[Gm->color]));			// count moves free of pawn attacks
-			 Val-=Paras[52].Val*Dval; 									// knight mobility
-			 if(Dval<2) Val+=Paras[53].Val*(2-Dval);					// bonus for trapped knight	
+			 Val-=PAR(52)*Dval; TRACE(V,52,-Dval);						// knight mobility
+			 if(Dval<2) {Val+=PAR(53)*(2-Dval); TRACE(V,53,2-Dval);}	// bonus for trapped knight
 			}
   			break;
   }
  }
  
- Val+=Paras[54].Val*(Popcount((~Mv->OATK[0])&CNTR)-						// malus for uncontrolled center squares
+ Val+=PAR(54)*(Popcount((~Mv->OATK[0])&CNTR)-							// malus for uncontrolled center squares
  		 	Popcount((~Mv->ADES)&CNTR));
+ TRACE(V,54,Popcount((~Mv->OATK[0])&CNTR)-Popcount((~Mv->ADES)&CNTR));
 
  Oval=Eval=0;															// reinit opening and endgame evaluation
 
@@ -3196,20 +4951,22 @@ short	Evaluation(Game* Gm, NNUE* Nn,  Mvs* Mv, short Alpha, short Beta)// evalua
 	//Oval+=(1-2*co)*(4-Dist[pk[1-co]][sp]);
    if(!(CM&PP[co]))														// half open file
    {
-    Oval+=Paras[56].Val*cl; Eval+=Paras[57].Val*cl;						// opening and endgame bonus
+    Oval+=PAR(56)*cl; Eval+=PAR(57)*cl; TRACE(O,56,cl); TRACE(E,57,cl);	// opening and endgame bonus
 	if(!(CM&PP[1-co]))													// open file
 	{
-	 Oval+=Paras[58].Val*cl; Eval+=Paras[59].Val*cl;					// opening and endgame bonus
-	 if(CM&PS) Oval+=Paras[60].Val*cl;									// double rooks 
+	 Oval+=PAR(58)*cl; Eval+=PAR(59)*cl;								// opening and endgame bonus
+	 TRACE(O,58,cl); TRACE(E,59,cl);
+	 if(CM&PS) {Oval+=PAR(60)*cl; TRACE(O,60,cl);}						// double rooks
     }
    }
-   else if(CM&PAP&PP[co]) Eval+=Paras[61].Val*cl;						// rook behind own passer 
-   if(PAWN_E[1-co][0][sp]&PAP&PP[1-co]) Eval+=Paras[62].Val*cl;			// rook behind opponent passer 
+   else if(CM&PAP&PP[co]) {Eval+=PAR(61)*cl; TRACE(E,61,cl);}			// rook behind own passer
+   if(PAWN_E[1-co][0][sp]&PAP&PP[1-co])									// rook behind opponent passer
+    {Eval+=PAR(62)*cl; TRACE(E,62,cl);}
    
    if((sp>>3)==(1+5*co))												// rook on 7th rank
    {
-   	Oval+=Paras[63].Val*cl;												// general opening bonus
-   	if((pk[1-co]>>3)==7*co) Oval+=Paras[64].Val*cl;						// bonus for opponent king on 8th rank
+   	Oval+=PAR(63)*cl; TRACE(O,63,cl);									// general opening bonus
+   	if((pk[1-co]>>3)==7*co) {Oval+=PAR(64)*cl; TRACE(O,64,cl);}			// bonus for opponent king on 8th rank
    }
    PS&=PS-1;
   }
@@ -3221,16 +4978,18 @@ short	Evaluation(Game* Gm, NNUE* Nn,  Mvs* Mv, short Alpha, short Beta)// evalua
  for(co=0; co<2; co++)
  {
   PS=Gm->POSITION[co][4]; cl=1-2*co;
-  Eval-=cl*Paras[65].Val*Popcount(PS&WS)*(Popcount(WS&MM)-5);			// malus for pawns on bishop color
-  Eval-=cl*Paras[65].Val*Popcount(PS&BS)*(Popcount(BS&MM)-5);			// malus for pawns on bishop color
+  Eval-=cl*PAR(65)*Popcount(PS&WS)*(Popcount(WS&MM)-5);					// malus for pawns on bishop color
+  TRACE(E,65,-cl*Popcount(PS&WS)*(Popcount(WS&MM)-5));
+  Eval-=cl*PAR(65)*Popcount(PS&BS)*(Popcount(BS&MM)-5);					// malus for pawns on bishop color
+  TRACE(E,65,-cl*Popcount(PS&BS)*(Popcount(BS&MM)-5));
   while(PS)								
   {
    sp=find_b[(PS^PS-1)%67];												// bishop 
    if((!(PAWN_E[co][6][sp]&PP[1-co]))&&(AP[co]&(A8<<sp)))				// bishop defended and not attackable by pawns
    {
-	Oval+=cl*Paras[66].Val;												// bonus for defence by pawn
-    if(co) 	{if(sp>31) Oval-=Paras[67].Val;} 							// bonus for outpost
-	else 	{if(sp<32) Oval+=Paras[67].Val;}	
+	Oval+=cl*PAR(66); TRACE(O,66,cl);									// bonus for defence by pawn
+    if(co) 	{if(sp>31) {Oval-=PAR(67); TRACE(O,67,-1);}}				// bonus for outpost
+	else 	{if(sp<32) {Oval+=PAR(67); TRACE(O,67,1);}}	
    }
    PS&=PS-1;
   } 
@@ -3245,9 +5004,9 @@ short	Evaluation(Game* Gm, NNUE* Nn,  Mvs* Mv, short Alpha, short Beta)// evalua
    sp=find_b[(PS^PS-1)%67];												// square of knight
    if((!(PAWN_E[co][6][sp]&PP[1-co]))&&(AP[co]&(A8<<sp)))				// knight defended and not attackable by pawns
    {
-   	Oval+=cl*Paras[68].Val;												// bonus for defence by pawn
-    if(co) 	{if(sp>31) Oval-=Paras[69].Val;} 							// bonus for outpost
-    else 	{if(sp<32) Oval+=Paras[69].Val;}
+   	Oval+=cl*PAR(68); TRACE(O,68,cl);									// bonus for defence by pawn
+    if(co) 	{if(sp>31) {Oval-=PAR(69); TRACE(O,69,-1);}}				// bonus for outpost
+    else 	{if(sp<32) {Oval+=PAR(69); TRACE(O,69,1);}}
    }
    PS&=PS-1;
   }
@@ -3262,36 +5021,37 @@ short	Evaluation(Game* Gm, NNUE* Nn,  Mvs* Mv, short Alpha, short Beta)// evalua
      ((CSW2&PP[0])==CSW2)||((CSW3&(PP[0]|CM))==CSW3)))||				// kingside area is save								
      ((p&0x22)&&(((CLW1&PP[0])==CLW1)||									// queenside castling done or possible
 	 ((CLW2&PP[0])==CLW2)||((CLW3&(PP[0]|CM))==CLW3))))					// queenside area is save
-	  Oval+=Paras[70].Val;												// castles possible
-  if(p&0x30) Oval+=Paras[71].Val;										// castles done	 		
+	  {Oval+=PAR(70); TRACE(O,70,1);}									// castles possible
+  if(p&0x30) {Oval+=PAR(71); TRACE(O,71,1);}							// castles done
   CM=Gm->POSITION[1][4];												// black pawns and bishops
   if(((p&0x44)&&(((CSB1&PP[1])==CSB1)||									// kingside castling done or possible
   	 ((CSB2&PP[1])==CSB2)||((CSB3&(PP[1]|CM))==CSB3)))||				// kingside area is save								
      ((p&0x88)&&(((CLB1&PP[1])==CLB1)||									// queenside castling done or possible
 	 ((CLB2&PP[1])==CLB2)||((CLB3&(PP[1]|CM))==CLB3)))) 				// queenside area is save
-	  Oval-=Paras[70].Val;												// castles possible
-  if(p&0xC0) Oval-=Paras[71].Val;										// castles done		
+	  {Oval-=PAR(70); TRACE(O,70,-1);}									// castles possible
+  if(p&0xC0) {Oval-=PAR(71); TRACE(O,71,-1);}							// castles done
  }
  
  // trapped bishop
  
  CM=Gm->POSITION[0][4];													// white bishops
  if(((CM&TWBBH)&&(PP[1]&TWBPH))||((CM&TWBBA)&&(PP[1]&TWBPA))) 			// trapped white bishop
-  {Oval-=Paras[72].Val; Eval-=Paras[73].Val;}
+  {Oval-=PAR(72); Eval-=PAR(73); TRACE(O,72,-1); TRACE(E,73,-1);}
   	
  CM=Gm->POSITION[1][4];													// black bishops
  if(((CM&TBBBH)&&(PP[0]&TBBPH))||((CM&TBBBA)&&(PP[0]&TBBPA)))			// trapped black bishop	
- {Oval+=Paras[72].Val; Eval+=Paras[73].Val;}
+ {Oval+=PAR(72); Eval+=PAR(73); TRACE(O,72,1); TRACE(E,73,1);}
  
  Dval=(Oval*gp+Eval*(24-gp))/24;										// tapered evaluation
  	
  if(Gm->color) Val-=Dval; else Val+=Dval;								// evaluation 
 
  STORE_EVAL:
- *(BitMap*)(ekey)=EHASH^(((BitMap)(Val)&0xFFFF)<<16); *(short*)(ekey)=Val;// store evaluation in hash table
+ *(BitMap*)(ekey)=((EHASH^(((BitMap)(Val)&0xFFFF)<<16))&~(BitMap)(0xFFFF))|// store evaluation in hash table ...
+ 				  ((BitMap)(Val)&0xFFFF);								// ... with one atomic write
 
  EVAL_END:
- return (Paras[12].Val+Val)*(100-(Gm->Moves[Gm->Move_n]).fifty)/100;	// stm bonus and 50-move reduction
+ return (PAR(12)+Val)*(100-(Gm->Moves[Gm->Move_n]).fifty)/100;			// stm bonus and 50-move reduction
 }
 
 short	Qsearch(Game* Gm, NNUE* Nnue, short Alpha, short Beta, Byte depth)// quiescence search
@@ -3311,10 +5071,11 @@ short	Qsearch(Game* Gm, NNUE* Nnue, short Alpha, short Beta, Byte depth)// quies
                                             (!Ponder)) Stop=true;	
  						
  if((Beta<=Alpha)||(Stop)) 					return Alpha;				// no search window or stop recognized
- if(DrawTest(Gm)) 							return Paras[74].Val-Dv;	// 3 or 50 draw
+ if(DrawTest(Gm)) 							return PAR(74)-Dv;			// 3 or 50 draw
  if(Gm->Move_n) (Gm->Moves[Gm->Move_n-1]).check=TestCheck(Gm,99);		// previous move was check?
  
- if(Options[4].Val)	Apriori=(recog[Gm->Matsig])(Gm,&inr);				// interior node recognition
+ if(Options[4].Val&&(Gm->Mexc||mat_t[Gm->MKEY].Rec))					// interior node recognition
+ 					Apriori=(recog[Gm->Matsig])(Gm,&inr);
  else inr=128;															// no INR
  if((inr&128)||(Gm->Moves[Gm->Move_n-1]).check) Apriori=MatEval(Gm);	// evaluation estimate is material value
  else if(!inr)								return Apriori;				// recognizer found exact score
@@ -3324,14 +5085,14 @@ short	Qsearch(Game* Gm, NNUE* Nnue, short Alpha, short Beta, Byte depth)// quies
   {if(Apriori>=Beta)  return Apriori; if(Apriori>Alpha) Alpha=Apriori;}	// INR brought fail low or narrowing
 
  if(Beta<=Alpha)							return Apriori;				// window too small
- if(Gm->phase<12) Posv=Paras[80].Val; else Posv=Paras[79].Val; 			// pruning values for end- and middlegame
+ if(Gm->phase<12) Posv=PAR(80); else Posv=PAR(79);						// pruning values for end- and middlegame
 
  if((Gm->Moves[Gm->Move_n-1]).check)									// in check
  {
   GenMoves(Gm,&Mv);														// generate moves
   if((Mv.cp==64)||(Mv.cp==128)||(Mv.cp==192)) 
   								return Gm->Move_n-Gm->Move_r-MaxScore;	// mate
-  else if(!(Mv.cp))							return Paras[74].Val-Dv;	// stalemate
+  else if(!(Mv.cp))							return PAR(74)-Dv;			// stalemate
   
   if(Options[8].Val) {Nn=*Nnue; NNUE_UpdateFeatures(Gm,&Nn);}			// update NNUE feature vector
  
@@ -3341,24 +5102,26 @@ short	Qsearch(Game* Gm, NNUE* Nnue, short Alpha, short Beta, Byte depth)// quies
  {
   if(Apriori-Posv>=Beta) 					return Apriori;				// real value will fail high
   if(Gm->POSITION[Gm->color][6]&(P7<<(40*Gm->color))) 					// stm might promote
-  		Expect=Paras[95].Val;											// expected promotion value
+  		Expect=PAR(95);													// expected promotion value
   else Expect=0;
-  if(Apriori+Expect+(Paras[5].Val+Paras[101].Val)/2+Posv<=Alpha) 
+  if(Apriori+Expect+(PAR(5)+PAR(101))/2+Posv<=Alpha) 
   											return Apriori; 			// even potential queen capture is not enough
   for(i=2;i<7;i++) if(Gm->POSITION[1-Gm->color][i])						// search for maximal possible material gain
-   {Expect+=(Paras[3+i].Val+Paras[99+i].Val)/2; break;}					// most valuable piece
+   {Expect+=PVAL(i); break;}											// most valuable piece
   if(Apriori+Expect+Posv<=Alpha) 			return Apriori; 			// even best possible gain is not enough
-  GenMoves(Gm,&Mv);														// generate moves
-  if(!(Mv.cp))								return Paras[74].Val-Dv;	// stalemate
   
   if(Options[8].Val) {Nn=*Nnue; NNUE_UpdateFeatures(Gm,&Nn);}			// update NNUE feature vector
   
+  Mv.cp=NOMOVES; if((Gm->Count[Gm->color]).officers<2) GenMoves(Gm,&Mv);	// only king and pawns: stalemate test before stand pat
   if(!(inr&64))	Apriori=Evaluation(Gm,&Nn,&Mv,Alpha,Beta);				// if no recognizer get position value, now we know POSV!
+  if(!(Mv.cp))								return PAR(74)-Dv;			// stalemate (if moves are known)
   if(Apriori>=Beta)							return Apriori;				// stand pat
   if(Apriori+Expect<=Alpha) 				return Apriori;				// even maximum mat. gain is insufficient
+  if(Mv.cp==NOMOVES) GenMoves(Gm,&Mv);									// generate moves, if evaluation did not need them
+  if(!(Mv.cp))								return PAR(74)-Dv;			// stalemate
   if(Apriori>Alpha) Alpha=Apriori;										// lower bound
   Bestval=Apriori; 
-  if(depth<(Byte)(Paras[81].Val)) Mv.flg=0x40; else Mv.flg=0;			// consider checks
+  if(depth<(Byte)(PAR(81))) Mv.flg=0x40; else Mv.flg=0;					// consider checks
  }
  
  Mv.o=0; Mv.s=100;														// init movepicker
@@ -3366,9 +5129,9 @@ short	Qsearch(Game* Gm, NNUE* Nnue, short Alpha, short Beta, Byte depth)// quies
  {
   if(!(Mv.flg&0x30))													// no check->delta pruning
   {
-   if(Mov&128) Expect=Paras[95].Val; else Expect=0;						// expected promotion value
+   if(Mov&128) Expect=PAR(95); else Expect=0;							// expected promotion value
    if(i=(Gm->Piece[1-Gm->color][(Mov>>8)&63]).type)
-   			Expect=(Paras[3+i].Val+Paras[99+i].Val)/2; 					// best expectation	
+   			Expect=PVAL(i);												// best expectation	
    if((Apriori+Expect+Posv<=Alpha)&&(!TestMCheck(Gm,&Mv,Mov))) continue;// delta pruning if no check
   }
   Move(Gm,Mov); ALLNODES++; 											// make move
@@ -3420,48 +5183,50 @@ void 	GetPV(Game* Gm)													// retrieve principal variation
 void 	PrintPV(Game* Gm, short Val, short Alpha, short Beta)			// print PV
 {
  Byte	i;
- char	Sm[10];
+ char	Sm[10],Ln[2048];
  short	Mm=Gm->Move_r;
+ int	l=0;
  double T2=(double)(clock()-StartTime)/CLOCKS_PER_SEC; 					// overall time passed
  Dbyte	Hf=(HASHFILL*1000)/HEN;											// hash table fill state
 
  if((Gm->Move_n-Gm->Move_r)&1) {Val=-Val; Alpha=-Alpha; Beta=-Beta;}	// pv in mid of tree
  GetPV(Gm);																// retrieve PV
-
+ if(Quiet) return;														// batch analysis prints result only
  if((midepth>1)&&((Fbyte)(clock()-StartTime)<CLOCKS_PER_SEC/10)&&		// no time to print during the first 1/10 s
  												(level!=5)) return;		// except for mate search
  
  if(Options[0].Val) 													// uci mode													
  {
-  printf("info depth %d seldepth %d ",Gm->idepth,Gm->Maxply);			// depth info
-  printf("time %d nodes %llu ",(int)(1000*T2),ALLNODES); 				// time and nodes
-  printf("nps %.0lf ",(double)(ALLNODES)/T2);							// nodes per second
-  printf("hashfull %d score ",Hf>1000?1000:Hf);							// hashtable fill status
-  if(Val>MaxScore-255) 		printf("mate %d ",(MaxScore-Val+1)/2);		// mate in n
-  else if(Val<255-MaxScore)	printf("mate -%d ",(Val+MaxScore+1)/2);		// -mate in n 
+  l+=sprintf(Ln+l,"info depth %d seldepth %d ",Gm->idepth,Gm->Maxply);	// depth info
+  l+=sprintf(Ln+l,"time %d nodes %llu ",(int)(1000*T2),ALLNODES); 		// time and nodes
+  l+=sprintf(Ln+l,"nps %.0lf ",(double)(ALLNODES)/T2);					// nodes per second
+  l+=sprintf(Ln+l,"hashfull %d score ",Hf>1000?1000:Hf);				// hashtable fill status
+  if(Val>MaxScore-255) 		l+=sprintf(Ln+l,"mate %d ",(MaxScore-Val+1)/2);	// mate in n
+  else if(Val<255-MaxScore)	l+=sprintf(Ln+l,"mate -%d ",(Val+MaxScore+1)/2);// -mate in n 
   else 
   {
    if(Val>9999) Val=9999;												// limit value to 100 Pawns
    else if(Val<-9999) Val=-9999;
    else if((Val>-5)&&(Val<5)) Val=0;									// smoothen draw values
-   printf("cp %d ",Val);
+   l+=sprintf(Ln+l,"cp %d ",Val);
   }
-  if(Val<=Alpha) 		printf("upperbound ");							// fail low
-  else if(Val>=Beta) 	printf("lowerbound ");							// fail high
-  if(Gm->mpv) printf("multipv %d ",Gm->mpv); else printf("pv ");		// prepare print of pv															
+  if(Val<=Alpha) 		l+=sprintf(Ln+l,"upperbound ");					// fail low
+  else if(Val>=Beta) 	l+=sprintf(Ln+l,"lowerbound ");					// fail high
+  if(Gm->mpv) l+=sprintf(Ln+l,"multipv %d ",Gm->mpv); 					// prepare print of pv
+  else l+=sprintf(Ln+l,"pv ");
  }
  else																	// terminal mode
  {
-  printf("Depth: %d/%d ",Gm->idepth,Gm->Maxply);						// depth		
-  if(Val>MaxScore-255)	printf("value=M%d",(int)((MaxScore-Val+1)/2));	// mate in n
-  else if(Val<255-MaxScore)	printf("value=-M%d",(int)((Val+MaxScore)/2));// -mate in n
-  else printf("value=%d",Val);											// print ordinary value
-  printf(" %llu nodes time=%.0lfs (%.0lf nodes/s)\nPV: ",				// print info
+  l+=sprintf(Ln+l,"Depth: %d/%d ",Gm->idepth,Gm->Maxply);				// depth		
+  if(Val>MaxScore-255)	l+=sprintf(Ln+l,"value=M%d",(int)((MaxScore-Val+1)/2));	// mate in n
+  else if(Val<255-MaxScore)	l+=sprintf(Ln+l,"value=-M%d",(int)((Val+MaxScore)/2));// -mate in n
+  else l+=sprintf(Ln+l,"value=%d",Val);									// print ordinary value
+  l+=sprintf(Ln+l," %llu nodes time=%.0lfs (%.0lf nodes/s)\nPV: ",		// print info
   		ALLNODES,(double)(T2),(double)(ALLNODES)/T2); 	
  }
- while((Gm->Moves[Mm]).Mov) 											// no Nullmoves
-  {UncodeMove((Gm->Moves[Mm]).Mov,Sm); printf("%-7s",Sm); Mm++;}		// get move from list
- printf("\n"); fflush(stdout);
+ while(((Gm->Moves[Mm]).Mov)&&(l<(int)sizeof(Ln)-10))					// no Nullmoves
+  {UncodeMove((Gm->Moves[Mm]).Mov,Sm); l+=sprintf(Ln+l,"%-7s",Sm); Mm++;}// get move from list
+ strcpy(Ln+l,"\n"); Output(Ln,true);									// queue complete line
  
  if(Options[9].Val) PrintStats();										// print search statistics
 
@@ -3470,38 +5235,43 @@ void 	PrintPV(Game* Gm, short Val, short Alpha, short Beta)			// print PV
 void	PrintStats()													// print search statistics
 {
  Byte	i;
+ char	Ln[200];
+ int	l;
  
  Stat[0].Val=(double)(100*(TTHIT1+TTHIT2)) 	/(double)(TTACC);			// tt hits
  Stat[1].Val=(double)(100*TTHIT2) 			/(double)(TTHIT1+TTHIT2);	// tthits second slot
  Stat[2].Val=(double)(100*TTCUT)  			/(double)(TTHIT1+TTHIT2);	// tt cuts
  Stat[3].Val=(double)(100*TTHLPR) 			/(double)(TTHIT1+TTHIT2);	// tt helper
  
- printf("info string Stats: ");											// print statistics
+ l=sprintf(Ln,"info string Stats: ");									// print statistics
  for(i=0;i<sizeof(Stat)/sizeof(Stat[0]);i++)
-  {printf("| %s: %.2lf %s ",Stat[i].Name,Stat[i].Val,Stat[i].Unit);}		// print value and units
- printf("\n"); fflush(stdout);
+  {l+=sprintf(Ln+l,"| %s: %.2lf %s ",Stat[i].Name,Stat[i].Val,Stat[i].Unit);}// print value and units
+ strcpy(Ln+l,"\n"); Output(Ln,true);
 }
 
 void 	PrintCurrent(Game* Gm, Dbyte Cm, Dbyte Nn)						// prints current move
 {
- char 	Sm[10];
+ char 	Sm[10],Ln[200];
+ int	l;
+ double	Tw;
  int	Hf=(HASHFILL*1000)/HEN;											// hash table fill state
  double T2=(double)(clock()-StartTime)/CLOCKS_PER_SEC; 					// overall time passed
  
  if(level!=5) if((Fbyte)(clock()-StartTime)<CLOCKS_PER_SEC/10) return;	// no time to print during the first 1/10 s
- if(Gm->Threadn) return;												// helpers cannot print
- UncodeMove(Cm,Sm);														// uncode move
+ if(Gm->Threadn||Quiet) return;											// helpers cannot print
+ if((Tw=WallTime())-TCurr<0.2) return;									// at most 5 currmove lines per second
+ TCurr=Tw; UncodeMove(Cm,Sm);											// uncode move
  
  if(Options[0].Val)														// UCI mode
  {
-  printf("info depth %d seldepth %d ",Gm->idepth,Gm->Maxply);			// depth info
-  printf("time %.0lf nodes %llu ",(double)(1000*T2),ALLNODES); 			// time and nodes
-  printf("nps %.0lf ",(double)(ALLNODES)/T2);							// nodes per second
-  printf("hashfull %d ",Hf>1000?1000:Hf);								// hashtable fill status
-  printf("currmove %s currmovenumber %d \n",Sm,Nn);						// print current move
+  l=sprintf(Ln,"info depth %d seldepth %d ",Gm->idepth,Gm->Maxply);		// depth info
+  l+=sprintf(Ln+l,"time %.0lf nodes %llu ",(double)(1000*T2),ALLNODES); // time and nodes
+  l+=sprintf(Ln+l,"nps %.0lf ",(double)(ALLNODES)/T2);					// nodes per second
+  l+=sprintf(Ln+l,"hashfull %d ",Hf>1000?1000:Hf);						// hashtable fill status
+  l+=sprintf(Ln+l,"currmove %s currmovenumber %d \n",Sm,Nn);			// print current move
  }
- else printf("current: %-7s\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b",Sm);		// print and move to start of line			
- fflush(stdout);														// flush stdout									
+ else sprintf(Ln,"current: %-7s\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b\b",Sm);	// print and move to start of line			
+ Output(Ln,false);														// may be dropped if output is slow
 }
 
 bool	TestLine(Game* Gm, Byte d)										// test sequence of moves
@@ -3540,14 +5310,14 @@ short	Search(Game* Gm, NNUE* Nnue, short Alpha, short Beta, Byte depth, Dbyte* B
   ((Fbyte)(1000*clock()/CLOCKS_PER_SEC-StartTime)>Tmax))) Stop=true;	// time exceeds hard break 
  					
  if((Beta<=Alpha)||(Stop)) 					return Alpha;				// no search window or stop recognized
- if(depth&&DrawTest(Gm)) if(Ply) 			return Paras[74].Val-Dv;	// draw according to 3-fold or 50 moves
+ if(depth&&DrawTest(Gm)) if(Ply) 			return PAR(74)-Dv;			// draw according to 3-fold or 50 moves
  if(((Gm->Moves[Gm->Move_n-1]).fifty)&&(Gm->Move_n>2))					// previous move was reversible
   if((Gm->Moves[Gm->Move_n-1]).from==(Gm->Moves[Gm->Move_n-3]).to)		// same piece moves again
   	(Gm->perm)++; else Gm->perm=0;										// sequence broken
  else Gm->perm=0;														// sequence broken
  
- if(depth>6) r=(Byte)(Paras[82].Val); 									// adaptive nullmove reduction
- else r=(Byte)(Paras[82].Val?Paras[82].Val-1:0);	
+ if(depth>6) r=(Byte)(PAR(82));											// adaptive nullmove reduction
+ else r=(Byte)(PAR(82)?PAR(82)-1:0);	
  PM=(Gm->Moves[Gm->Move_n]).HASH; PM^=(PM>>32); PM^=(PM>>16);			// fold hash signature to 16 bit 
  
  if((HM=GetHash(Gm))&&(Ply||(Gm->mpv<2)))								// TT entry found
@@ -3585,9 +5355,9 @@ short	Search(Game* Gm, NNUE* Nnue, short Alpha, short Beta, Byte depth, Dbyte* B
  
  if(Options[8].Val) {Nn=*Nnue; if(Ply) NNUE_UpdateFeatures(Gm,&Nn);}	// copy NNUE data update with last move
  
- if((!(*Bestm))&&Paras[84].Val&&(depth>(Byte)(Paras[84].Val)))			// get best move from Internal iterative deepening
+ if((!(*Bestm))&&PAR(84)&&(depth>(Byte)(PAR(84))))						// get best move from Internal iterative deepening
  {
-  Search(Gm,&Nn,Alpha,Beta,depth-(Byte)(Paras[84].Val),Bestm);			// search with reduced depth
+  Search(Gm,&Nn,Alpha,Beta,depth-(Byte)(PAR(84)),Bestm);				// search with reduced depth
   *Bestm&=0xFFBF;
  }
  
@@ -3599,7 +5369,7 @@ short	Search(Game* Gm, NNUE* Nnue, short Alpha, short Beta, Byte depth, Dbyte* B
  
  GenMoves(Gm,&Mv); NM=Mv.AMVS&(Mv.AMVS-1);								// generate moves
  
- if(!(Mv.cp))								 return Paras[74].Val-Dv;	// stalemate
+ if(!(Mv.cp))								 return PAR(74)-Dv;			// stalemate
  if(!NM) 						   							flg|=32;	// one move only?
  if(Gm->Move_n) 
   if(Mv.cp&192) {(Gm->Moves[Gm->Move_n-1]).check=true; 		flg|=64;}	// last move was a check
@@ -3607,7 +5377,8 @@ short	Search(Game* Gm, NNUE* Nnue, short Alpha, short Beta, Byte depth, Dbyte* B
  if((Mv.cp==64)||(Mv.cp==128)||(Mv.cp==192)) 							// mate
   							{Bestval=Ply-MaxScore; goto Hash;}
 							  							
- if((Ply>2)&&(!(flg&64))&&(Options[4].Val))								// interior node recognizer
+ if((Ply>2)&&(!(flg&64))&&(Options[4].Val)&&
+ 	(Gm->Mexc||mat_t[Gm->MKEY].Rec))									// interior node recognizer
  {
   Val=(recog[Gm->Matsig])(Gm,&inr);										// interior node recognition
   if((inr&128)&&((Val>MaxScore-255)||(Val<255-MaxScore))) 	flg|=16;	// mate value
@@ -3634,7 +5405,7 @@ short	Search(Game* Gm, NNUE* Nnue, short Alpha, short Beta, Byte depth, Dbyte* B
 
  NM&=NM-1; if(!NM) flg|=32; NM&=NM-1;									// at least three legal moves
 
- if(Paras[82].Val&&Ply&&(Gm->Move_n>2)&&(!(flg&72))&&NM&&((Mv.cp&15)>1)	// nullmove pruning allowed, not at ply0, at least 3 moves...
+ if(PAR(82)&&Ply&&(Gm->Move_n>2)&&(!(flg&72))&&NM&&((Mv.cp&15)>1)		// nullmove pruning allowed, not at ply0, at least 3 moves...
     &&((Gm->Moves[Gm->Move_n-1]).Mov||(Gm->Moves[Gm->Move_n-2]).Mov))	// ... and 2 pieces, no check, allow silent moves after check	
  {																		// double null allowed but not 3 in a row
   Move(Gm,0);															// make nullmove
@@ -3642,7 +5413,7 @@ short	Search(Game* Gm, NNUE* Nnue, short Alpha, short Beta, Byte depth, Dbyte* B
   else				 Val=- Search(Gm,&Nn,-Beta,1-Beta,depth-r-1,&Bm);	// nullsearch with reduction r
   UnMove(Gm);															// take back nullmove
   if((Val<255-MaxScore)) 									flg|=4;		// mate threat
-  if((Val<=Alpha-Paras[85].Val)&&(depth==2))							// deep search condition? nullmove fails low and ...
+  if((Val<=Alpha-PAR(85))&&(depth==2))									// deep search condition? nullmove fails low and ...
   {
    if(!(flg&128)) {(Gm->Moves[Gm->Move_n]).Val=MatEval(Gm); flg|=128;}	// ... evaluation ...
    if((Gm->Moves[Gm->Move_n]).Val>=Beta)					flg|=2;		// ... fails high
@@ -3653,19 +5424,19 @@ short	Search(Game* Gm, NNUE* Nnue, short Alpha, short Beta, Byte depth, Dbyte* B
 																		// multicut pruning
  Mcval=Val=Ply-MaxScore;
  
- if((Paras[83].Val)&&Ply&&(!(flg&80))&&(depth>(Byte)(Paras[83].Val))&&
+ if((PAR(83))&&Ply&&(!(flg&80))&&(depth>(Byte)(PAR(83)))&&
      (Gm->phase)&&(flg&1))
  {	
   MvB=Mv;  MvB.o=MvB.s=m=cm=0; MvB.flg=0x70; 							// backup move list prepare pickmoves
-  while((Mov=PickMove(Gm,&MvB))&&(cm<(Byte)(Paras[86].Val)))			// pick first n moves
+  while((Mov=PickMove(Gm,&MvB))&&(cm<(Byte)(PAR(86))))					// pick first n moves
   {
    cm++;																// count move
    Move(Gm,Mov); ALLNODES++;											// make move
-   if(depth<(Byte)(Paras[83].Val)+2) Val=-Qsearch(Gm,&Nn,-Beta,1-Beta,0);	// quiescence search
-   else	Val=-Search(Gm,&Nn,-Beta,1-Beta,depth-(Byte)(Paras[83].Val)-1,&Bm);	// test beta cutoff with reduced depth
+   if(depth<(Byte)(PAR(83))+2) Val=-Qsearch(Gm,&Nn,-Beta,1-Beta,0);			// quiescence search
+   else	Val=-Search(Gm,&Nn,-Beta,1-Beta,depth-(Byte)(PAR(83))-1,&Bm);		// test beta cutoff with reduced depth
    UnMove(Gm);															// take back move
    if(Val>Mcval) Mcval=Val;												// best value so far
-   if(Val>=Beta) if(++m>=(Byte)(Paras[87].Val)) 	return Mcval;		// multi cutoff
+   if(Val>=Beta) if(++m>=(Byte)(PAR(87))) 	return Mcval;				// multi cutoff
    if(Stop)											return Bestval;		// stop recognized
   }																		// no multicut
  }
@@ -3708,10 +5479,10 @@ short	Search(Game* Gm, NNUE* Nnue, short Alpha, short Beta, Byte depth, Dbyte* B
     (Beta>255-MaxScore)&&(Beta<MaxScore-255)&&(depth<5)&&(!ext))		// no mate values not giving check no extension
   {
    Val=(Gm->Moves[Gm->Move_n]).Val; Mcval=Alpha-Val;					// Alpha - node value
-   if(cap)		Mcval-=(Paras[cap+3].Val+Paras[cap+99].Val)/2;			// subtract material gain
-   if(Mov&128)	Mcval-=(Paras[(Mov>>14)+5].Val+Paras[(Mov>>14)+101].Val-// subtract material gain of promotion
-   						Paras[9].Val-Paras[105].Val)/2;				
-   if(Mcval>Paras[74+depth].Val) 							goto AEL;	// futility pruning
+   if(cap)		Mcval-=PVAL(cap);										// subtract material gain
+   if(Mov&128)	Mcval-=(PAR((Mov>>14)+5)+PAR((Mov>>14)+101)-			// subtract material gain of promotion
+   						PAR(9)-PAR(105))/2;				
+   if(Mcval>PAR(74+depth)) 							goto AEL;			// futility pruning
   }
   NC=Gm->NODES;															// backup nodecount
   Move(Gm,Mov);	ALLNODES++;	(Gm->NODES)++;								// make move
@@ -3724,15 +5495,15 @@ short	Search(Game* Gm, NNUE* Nnue, short Alpha, short Beta, Byte depth, Dbyte* B
   }
   else
   {
-   if((flg&64)||(Mov&64)||(Mv.s<35)||(!Ply)||(!(Paras[88].Val))||		// in check or giving check, PV, tactical, root, no LMR,...
+   if((flg&64)||(Mov&64)||(Mv.s<35)||(!Ply)||(!(PAR(88)))||				// in check or giving check, PV, tactical, root, no LMR,...
     ((Gm->Count[1-Gm->color]).pawns+(Gm->Count[1-Gm->color]).officers<3)// stm has only one piece/pawn left
 	||((Gm->Count[0]).officers<2)||((Gm->Count[1]).officers<2)||		// one side has no pieces left
 	(Mv.PINS&(A8<<from))||TestAttk(Gm,type,to,Gm->color))				// moving a pinned piece or higher piece is attacked-> no lmr
 	lmr=0;		
    else 
    {
-    lmr=depth/(Byte)(Paras[88].Val); 									// lmr based on depth, move selector state and deep search
-	if((Mv.s>54)&&(!(flg&2))) lmr+=(Byte)(Paras[94].Val);
+    lmr=depth/(Byte)(PAR(88));											// lmr based on depth, move selector state and deep search
+	if((Mv.s>54)&&(!(flg&2))) lmr+=(Byte)(PAR(94));
    }	 
 
    if(depth+ext<=1+lmr) Val=-Qsearch(Gm,&Nn,-Alpha-1,-Alpha,0);			// null window quiescence search
@@ -3887,7 +5658,7 @@ void	IterateSearch(Game* Gm)											// search for best move
  StartTime=1000*clock()/CLOCKS_PER_SEC;	                                // start time in milliseconds
  Gm->Maxply=0; ALLNODES=0; Gm->Pv[(Dbyte)(BM)]=0;	                    // initialize global values
  
- Stop=false; Gm->Move2Make=0; Gm->Lastbest=0; Gm->Pmove=0;				// initialize game parameters
+ Gm->Move2Make=0; Gm->Lastbest=0; Gm->Pmove=0;							// initialize game parameters
  Gm->Move_r=Gm->Move_n;
  
  if(Options[3].Val)														// debug 
@@ -3913,7 +5684,7 @@ void	IterateSearch(Game* Gm)											// search for best move
  }
  
  if((level!=1)&&((Gm->Move_r<40)||(Tmax>4000)))							// if there is not enought time  ... 
-  if(Gm->Move2Make=Book(Gm)) 	{printf("info string Book\n"); return;}	// ... check book only for first 20 moves 
+  if(Gm->Move2Make=Book(Gm)) 	{Output("info string Book\n",true); return;}	// ... check book only for first 20 moves 
  
  if(((!(Gm->Root[1]).Mov))&&(level!=1)&&(!Ponder)) 						// one legal move only
   {Gm->Move2Make=(Gm->Root[0]).Mov; return;} 	
@@ -3978,7 +5749,7 @@ void	IterateSearch(Game* Gm)											// search for best move
 
   if(Stop) Val=Gm->Lastval; else Gm->Lastval=Val;						// backup last value
   
-  if(midepth>2) {Malpha=Val-Paras[89].Val; Mbeta=Val+Paras[89].Val;}	// set aspiration window
+  if(midepth>2) {Malpha=Val-PAR(89); Mbeta=Val+PAR(89);}				// set aspiration window
   else			{Malpha=-MaxScore; Mbeta=MaxScore;}						// maximal window
   if(Val<255-MaxScore) Malpha=-MaxScore; 								// at most some mate against stm
   if(Val>MaxScore-255) Mbeta=MaxScore;									// at least some mate for stm
@@ -4026,20 +5797,18 @@ void	FindMate(Game* Gm)
  short			Bestval;
  bool			mcheck;
  Dbyte			Mov,Bestmove,sol=0;
+ char			Ln[100];
 
  StartTime=clock(); Gm->Maxply=Gm->idepth=2*nmate-1; Gm->Lastbest=0;	// init values
- ALLNODES=Gm->NODES=0; Gm->Finished=true; Stop=false; ClearTables();
+ ALLNODES=Gm->NODES=0; Gm->Finished=true; ClearTables();
  Gm->Move2Make=0;
  for(i=0;i<Paras[93].Val;i++) {Gp[i]=*Gm; Gp[i].Threadn=i+1;}			// initialize threads
  GenMoves(Gm,&Mv); 														// generate moves
  if((!(Mv.cp))||(Mv.cp==64)||(Mv.cp==128)||(Mv.cp==192)) return;		// stalemate or mate
  Mv.o=cm=0; Mv.s=200; Bestval=-MaxScore; Bestmove=0;					// init move picker
  
- if(Options[0].Val)														// UCI mode
-  printf("info string using %d threads to find mate in %d ...\n",
-  	Paras[93].Val,nmate);
- else printf("using %d threads to find mate in %d ...\n",				// terminal mode
- 	Paras[93].Val,nmate);	
+ sprintf(Ln,"%susing %d threads to find mate in %d ...\n",				// "info string" in UCI mode
+ 	Options[0].Val?"info string ":"",Paras[93].Val,nmate); Output(Ln,true);	
  
  while(Mov=PickMove(Gm,&Mv))											// loop through moves
  { 
@@ -4070,9 +5839,8 @@ void	FindMate(Game* Gm)
  }
  Gm->Move2Make=Bestmove;												// suggest best move
  
- if(Options[0].Val)														// UCI mode
-  printf("info string found %d solutions for mate in %d\n",sol,nmate);
- else printf("found %d solutions for mate in %d\n",sol,nmate);			// terminal mode	
+ sprintf(Ln,"%sfound %d solutions for mate in %d\n",					// "info string" in UCI mode
+ 	Options[0].Val?"info string ":"",sol,nmate); Output(Ln,true);	
 }
 
 void	*SmpMateHelper(void* Ms)
@@ -4165,7 +5933,7 @@ short 	KvK(Game* Gm, Byte *flags)										// lone kings: checked
  if(dv&1) dv=5-(dv>5?5:dv); else dv=0;									// accelerates draw if inevitable
  
  *flags=0;																// exact score
- return Paras[74].Val-dv;												// draw: insufficient material
+ return PAR(74)-dv;														// draw: insufficient material
 }
 
 short 	KPvK(Game* Gm, Byte *flags)										// checked
@@ -4174,7 +5942,7 @@ short 	KPvK(Game* Gm, Byte *flags)										// checked
  Byte 	wp,mwk,mbk,bk,wk;	
  BitMap AM,BM=Gm->POSITION[0][6];										// white pawn(s)
 
- Val=(Gm->Count[0]).pawns*Paras[105].Val; AM=BM;							// material value of pawns
+ Val=(Gm->Count[0]).pawns*PAR(105); AM=BM;									// material value of pawns
  bk=(Gm->Officer[1][0]).square;	wk=(Gm->Officer[0][0]).square;			// position of kings
  
  while(BM)
@@ -4190,11 +5958,11 @@ short 	KPvK(Game* Gm, Byte *flags)										// checked
   }
   if((A8<<mwk)&KPVK[((wp>>3)-1)*4+(wp&3)][Gm->color*64+mbk])			// position is won
   {
-   Val+=Paras[101].Val-Paras[105].Val-100;								// value is queen-pawn-promotion bonus
+   Val+=PAR(101)-PAR(105)-100;											// value is queen-pawn-promotion bonus
    *flags=0; if(Gm->color) return -Val; else return Val;				// evaluation depends on stm
   }
  }
- if((Gm->Count[0]).pawns==1) {*flags=0; return Paras[74].Val;}			// lone pawn is exactly draw
+ if((Gm->Count[0]).pawns==1) {*flags=0; return PAR(74);}				// lone pawn is exactly draw
  if(Gm->color) {*flags=1; return -Val;}									// black has upper bound
  *flags=2; return Val;													// white has lower bound
 }
@@ -4205,7 +5973,7 @@ short 	KvKP(Game* Gm, Byte *flags)										// checked
  Byte 	bp,mwk,mbk,wk,bk;
  BitMap AM,BM=Gm->POSITION[1][6];										// black pawn(s)
  
- Val=(Gm->Count[1]).pawns*Paras[105].Val; AM=BM;						// material value of pawns
+ Val=(Gm->Count[1]).pawns*PAR(105); AM=BM;								// material value of pawns
  bk=(Gm->Officer[1][0]).square;	wk=(Gm->Officer[0][0]).square;			// position of kings
 
  while(BM)
@@ -4222,11 +5990,11 @@ short 	KvKP(Game* Gm, Byte *flags)										// checked
   
   if((A8<<mbk)&KPVK[((bp>>3)-1)*4+(bp&3)][(1-Gm->color)*64+mwk])		// position is won
   {
-   Val+=Paras[101].Val-Paras[105].Val-100;								// value is queen-pawn-promotion bonus
+   Val+=PAR(101)-PAR(105)-100;											// value is queen-pawn-promotion bonus
    *flags=0; if(Gm->color) return Val; else return -Val;				// evaluation depends on stm
   }
  }
- if((Gm->Count[1]).pawns==1) {*flags=0; return Paras[74].Val;}			// lone pawn is exactly draw
+ if((Gm->Count[1]).pawns==1) {*flags=0; return PAR(74);}				// lone pawn is exactly draw
  if(Gm->color) {*flags=2; return Val;}									// black has lower bound
  *flags=1; return -Val;													// white has upper bound
 }
@@ -4238,14 +6006,14 @@ short 	KNvK(Game* Gm, Byte *flags)										// white has knight(s)
  BitMap WN=Gm->POSITION[0][5];											// position of knight(s)
  
  bk=(Gm->Officer[1][0]).square;	wk=(Gm->Officer[0][0]).square;			// position of kings
- if((Gm->Count[0]).officers<4) {*flags=0; return Paras[74].Val;}		// less than 3 knights
+ if((Gm->Count[0]).officers<4) {*flags=0; return PAR(74);}				// less than 3 knights
  Val=10*Dist_c[bk]-5*Dist[wk][bk];										// distance from center and king
  if(Gm->color) *flags=1; else *flags=2;									// white has at least pos value
  if(WN&STEP[1][bk]) *flags=64;											// knight is attacked
  while(WN)																// parse knights
  {
   n=find_b[(WN^WN-1)%67]; WN&=WN-1; 									// next knight
-  Val+=38+Paras[104].Val-4*Dist_c[n]-Dist_s[bk][n]; 					// distance of knight to bK and center
+  Val+=38+PAR(104)-4*Dist_c[n]-Dist_s[bk][n];							// distance of knight to bK and center
  }
  if(Gm->color) return -Val; else return Val;
 }
@@ -4257,14 +6025,14 @@ short 	KvKN(Game* Gm, Byte *flags)										// black has knight(s)
  BitMap BN=Gm->POSITION[1][5];											// position of knight(s)
  
  bk=(Gm->Officer[1][0]).square;	wk=(Gm->Officer[0][0]).square;			// position of kings
- if((Gm->Count[1]).officers<4) {*flags=0; return Paras[74].Val;}		// less than 3 knights
+ if((Gm->Count[1]).officers<4) {*flags=0; return PAR(74);}				// less than 3 knights
  Val=10*Dist_c[wk]-5*Dist[wk][bk];										// distance from center and king
  if(Gm->color) *flags=2; else *flags=1;									// black has at least pos value
  if(BN&STEP[1][wk]) *flags=64;											// knight is attacked
  while(BN)																// parse knights
  {
   n=find_b[(BN^BN-1)%67]; BN&=BN-1; 									// next knight
-  Val+=38+Paras[104].Val-4*Dist_c[n]-Dist_s[wk][n]; 					// distance of knight to wK and center
+  Val+=38+PAR(104)-4*Dist_c[n]-Dist_s[wk][n];							// distance of knight to wK and center
  }
  if(Gm->color) return Val; else return -Val;
 }
@@ -4276,9 +6044,9 @@ short 	KBvK(Game* Gm, Byte *flags)
  BitMap BM=Gm->POSITION[0][4];											// position of white bishop(s)
  
  bk=(Gm->Officer[1][0]).square;	wk=(Gm->Officer[0][0]).square;			// position of kings
- if(!((BM&WS)&&(BM&BS))) {*flags=0; return Paras[74].Val;}				// lone bishop or all on same color
+ if(!((BM&WS)&&(BM&BS))) {*flags=0; return PAR(74);}					// lone bishop or all on same color
  Val=50+20*Dist_c[bk]-5*Dist[wk][bk];									// distance of kings, score
- while(BM) {BM&=BM-1; Val+=Paras[103].Val;}								// add material value of bishops				
+ while(BM) {BM&=BM-1; Val+=PAR(103);}									// add material value of bishops				
  if(Gm->color) {*flags=1; Val=-Val;} else *flags=2;						// black has at most pos val maybe lost
  if(STEP[1][bk]&Gm->POSITION[0][0]) *flags=64;							// bishop under attack: no guess
  return Val;
@@ -4291,9 +6059,9 @@ short 	KvKB(Game* Gm, Byte *flags)
  BitMap BM=Gm->POSITION[1][4];											// position of black bishop(s)
  
  bk=(Gm->Officer[1][0]).square;	wk=(Gm->Officer[0][0]).square;			// position of kings
- if(!((BM&WS)&&(BM&BS))) {*flags=0; return Paras[74].Val;}				// lone bishop or all on same color
+ if(!((BM&WS)&&(BM&BS))) {*flags=0; return PAR(74);}					// lone bishop or all on same color
  Val=50+20*Dist_c[wk]-5*Dist_s[wk][bk];									// distance of kings, score
- while(BM) {BM&=BM-1; Val+=Paras[103].Val;}								// add material value of bishops				
+ while(BM) {BM&=BM-1; Val+=PAR(103);}									// add material value of bishops				
  if(Gm->color) *flags=2; else {*flags=1; Val=-Val;}						// black has at least pos val maybe won
  if(STEP[1][wk]&Gm->POSITION[1][0]) *flags=64;							// bishop under attack: no guess
  return Val;															// white has at most pos valmaybe lost
@@ -4307,9 +6075,9 @@ short 	KRvK(Game* Gm, Byte *flags)										// also KR(B/N)vK
  
  bk=(Gm->Officer[1][0]).square;	wk=(Gm->Officer[0][0]).square;			// position of kings
  Val=120+20*Dist_c[bk]-5*Dist_s[bk][wk];								// distance of kings, score
- while(BM) {Val+=20+Paras[102].Val; BM&=BM-1;}							// add material value of rooks
- BM=Gm->POSITION[0][4]; while(BM) {Val+=20+Paras[103].Val; BM&=BM-1;}	// add material value of bishops
- BM=Gm->POSITION[0][5]; while(BM) {Val+=20+Paras[104].Val; BM&=BM-1;}	// add material value of knights
+ while(BM) {Val+=20+PAR(102); BM&=BM-1;}								// add material value of rooks
+ BM=Gm->POSITION[0][4]; while(BM) {Val+=20+PAR(103); BM&=BM-1;}			// add material value of bishops
+ BM=Gm->POSITION[0][5]; while(BM) {Val+=20+PAR(104); BM&=BM-1;}			// add material value of knights
  if(Gm->color) {*flags=1; Val=-Val;} else *flags=2;						// white has at least pos val maybe won
  if(STEP[1][bk]&Gm->POSITION[0][0]) *flags=64;							// pieces under attack: no guess
  return Val;															// black has at most pos val maybe lost
@@ -4323,9 +6091,9 @@ short 	KvKR(Game* Gm, Byte *flags)										// also KvKR(B/N)
  
  bk=(Gm->Officer[1][0]).square;	wk=(Gm->Officer[0][0]).square;			// position of kings
  Val=120+20*Dist_c[wk]-5*Dist_s[bk][wk];								// distance of kings, score
- while(BM) {Val+=20+Paras[102].Val; BM&=BM-1;}							// add material value of rooks
- BM=Gm->POSITION[1][4]; while(BM) {Val+=20+Paras[103].Val; BM&=BM-1;}	// add material value of bishops
- BM=Gm->POSITION[1][5]; while(BM) {Val+=20+Paras[104].Val; BM&=BM-1;}	// add material value of knights
+ while(BM) {Val+=20+PAR(102); BM&=BM-1;}								// add material value of rooks
+ BM=Gm->POSITION[1][4]; while(BM) {Val+=20+PAR(103); BM&=BM-1;}			// add material value of bishops
+ BM=Gm->POSITION[1][5]; while(BM) {Val+=20+PAR(104); BM&=BM-1;}			// add material value of knights
  if(Gm->color) *flags=2; else {*flags=1; Val=-Val;}						// black has at least pos val maybe won
  if(STEP[1][wk]&Gm->POSITION[1][0]) *flags=64;							// pieces under attack: no guess
  return Val;															// white has at most pos val maybe lost
@@ -4339,10 +6107,10 @@ short 	KQvK(Game* Gm, Byte *flags)										// also KQ(R/B/N)vK
  
  bk=(Gm->Officer[1][0]).square;	wk=(Gm->Officer[0][0]).square;			// position of kings
  Val=200+15*Dist_c[bk]-10*Dist_s[bk][wk];								// distance of kings, score
- while(BM) {Val+=20+Paras[101].Val; BM&=BM-1;}							// add material value of queens
- BM=Gm->POSITION[0][3]; while(BM) {Val+=20+Paras[102].Val; BM&=BM-1;}	// add material value of rooks
- BM=Gm->POSITION[0][4]; while(BM) {Val+=20+Paras[103].Val; BM&=BM-1;}	// add material value of bishops
- BM=Gm->POSITION[0][5]; while(BM) {Val+=20+Paras[104].Val; BM&=BM-1;}	// add material value of knights
+ while(BM) {Val+=20+PAR(101); BM&=BM-1;}								// add material value of queens
+ BM=Gm->POSITION[0][3]; while(BM) {Val+=20+PAR(102); BM&=BM-1;}			// add material value of rooks
+ BM=Gm->POSITION[0][4]; while(BM) {Val+=20+PAR(103); BM&=BM-1;}			// add material value of bishops
+ BM=Gm->POSITION[0][5]; while(BM) {Val+=20+PAR(104); BM&=BM-1;}			// add material value of knights
  if(Gm->color) {*flags=1; Val=-Val;} else *flags=2;						// black has at least pos value
  if(STEP[1][bk]&Gm->POSITION[0][0]) *flags=64;							// pieces under attack: no guess
  return Val;															// black has at most pos val maybe lost
@@ -4356,10 +6124,10 @@ short 	KvKQ(Game* Gm, Byte *flags)										// also KvKQ(R/B/N)
 
  bk=(Gm->Officer[1][0]).square;	wk=(Gm->Officer[0][0]).square;			// position of kings
  Val=200+15*Dist_c[wk]-10*Dist_s[bk][wk];								// distance of kings, score
- while(BM) {Val+=20+Paras[101].Val; BM&=BM-1;}							// add material value of queens
- BM=Gm->POSITION[1][3]; while(BM) {Val+=20+Paras[102].Val; BM&=BM-1;}	// add material value of rooks
- BM=Gm->POSITION[1][4]; while(BM) {Val+=20+Paras[103].Val; BM&=BM-1;}	// add material value of bishops
- BM=Gm->POSITION[1][5]; while(BM) {Val+=20+Paras[104].Val; BM&=BM-1;}	// add material value of knights
+ while(BM) {Val+=20+PAR(101); BM&=BM-1;}								// add material value of queens
+ BM=Gm->POSITION[1][3]; while(BM) {Val+=20+PAR(102); BM&=BM-1;}			// add material value of rooks
+ BM=Gm->POSITION[1][4]; while(BM) {Val+=20+PAR(103); BM&=BM-1;}			// add material value of bishops
+ BM=Gm->POSITION[1][5]; while(BM) {Val+=20+PAR(104); BM&=BM-1;}			// add material value of knights
  if(Gm->color) *flags=2; else {*flags=1; Val=-Val;}						// black has at least pos value
  if(STEP[1][wk]&Gm->POSITION[1][0]) *flags=64;							// pieces under attack: no guess
  return Val;															// white has at most pos val maybe lost
@@ -4379,9 +6147,9 @@ short 	KBNvK(Game* Gm, Byte *flags)									// white has bishop(s) and knight(s)
  while(WN)																// parse knights
  {
   n=find_b[(WN^WN-1)%67]; WN&=WN-1;										// next knight
-  Val+=34+Paras[104].Val-Dist_s[bk][n]; 								// material and distance of knight to bK
+  Val+=34+PAR(104)-Dist_s[bk][n];										// material and distance of knight to bK
  }
- while(WB) {Val+=20+Paras[103].Val; WB&=WB-1;}							// add bishop's material value	
+ while(WB) {Val+=20+PAR(103); WB&=WB-1;}								// add bishop's material value	
  if(Gm->color) return -Val; else return Val;							// black has at most pos val maybe lost
 }
 
@@ -4399,9 +6167,9 @@ short 	KvKBN(Game* Gm, Byte *flags)									// black has bishop(s) and knight(s)
  while(BN)																// parse knights
  {
   n=find_b[(BN^BN-1)%67]; BN&=BN-1;										// next knight
-  Val+=34+Paras[104].Val-Dist_s[wk][n]; 								// material and distance of knight to wK
+  Val+=34+PAR(104)-Dist_s[wk][n];										// material and distance of knight to wK
  }
- while(BB) {Val+=20+Paras[103].Val; BB&=BB-1;}							// add bishop's material value	
+ while(BB) {Val+=20+PAR(103); BB&=BB-1;}								// add bishop's material value	
  if(Gm->color) return Val; else return -Val;							// white has at most pos val maybe lost
 }
 
@@ -4410,7 +6178,7 @@ short 	KNPvK(Game* Gm, Byte *flags)
  BitMap WP=Gm->POSITION[0][6];											// position of white pawns
  
  if(((Gm->Count[0]).officers==2)&&((Gm->Count[0]).pawns==1)&&(WP&A7H7)&&
-    ((WP>>8)&Gm->POSITION[1][1])) {*flags=0; return Paras[74].Val;}  	// exact draw
+    ((WP>>8)&Gm->POSITION[1][1])) {*flags=0; return PAR(74);}			// exact draw
  
  *flags=128; return 0;													// no guess
 }
@@ -4420,7 +6188,7 @@ short 	KvKNP(Game* Gm, Byte *flags)
  BitMap BP=Gm->POSITION[1][6];											// position of black pawns
  
  if(((Gm->Count[1]).officers==2)&&((Gm->Count[1]).pawns==1)&&(BP&A2H2)&&
-    ((BP<<8)&Gm->POSITION[0][1])) {*flags=0; return Paras[74].Val;}  	// exact draw
+    ((BP<<8)&Gm->POSITION[0][1])) {*flags=0; return PAR(74);}			// exact draw
  
  *flags=128; return 0;													// no guess
 }
@@ -4438,7 +6206,7 @@ short 	KBPvK(Game* Gm, Byte *flags)
  
  if(((Gm->Count[0]).officers>2)||(((~A)&WP)&&((~H)&WP))) return 0;		// more than one bishop or pawns not on a/h files
  *flags=64;																// default is unclear
- Val=3*n*n+(Gm->Count[0]).pawns*Paras[105].Val;							// value of pawn(s)
+ Val=3*n*n+(Gm->Count[0]).pawns*PAR(105);								// value of pawn(s)
  Val+=2*Dist[bk][wps]-Dist[wk][wps];									// distance to pawn
  if(Gm->color) p=0; else p=8;											// stm correction for Berger
  if((!(BKB&PAWN_E[0][2][wps-p]))&&
@@ -4448,7 +6216,7 @@ short 	KBPvK(Game* Gm, Byte *flags)
  else 
  {
   p=Dist[bk][wps&7]; Val+=10*p;											// distance to promotion square
-  if(p<1) {*flags=0; return Paras[74].Val;}								// king controls promotion square exact draw
+  if(p<1) {*flags=0; return PAR(74);}									// king controls promotion square exact draw
  }
  if(Gm->color) return -Val; else return Val;
 }
@@ -4467,7 +6235,7 @@ short 	KvKBP(Game* Gm, Byte *flags)
  *flags=64;																// default is unclear
  while(BP) {bps=find_b[(BP^BP-1)%67]; BP&=BP-1;}						// most advanced pawn
  n=bps>>3;																// rank of that pawn															
- Val=3*n*n+(Gm->Count[1]).pawns*Paras[105].Val;							// value of pawn(s)
+ Val=3*n*n+(Gm->Count[1]).pawns*PAR(105);								// value of pawn(s)
  Val+=2*Dist[wk][bps]-Dist[bk][bps];									// distance to pawn
  
  if(Gm->color) p=8; else p=0;											// stm correction for Berger
@@ -4478,7 +6246,7 @@ short 	KvKBP(Game* Gm, Byte *flags)
  else 
  {	
   p=Dist[wk][56+(bps&7)]; Val+=10*p; 									// distance to promotion square
-  if(p<1) {*flags=0; return Paras[74].Val;}								// king controls promotion square exact draw
+  if(p<1) {*flags=0; return PAR(74);}									// king controls promotion square exact draw
  }
  if(Gm->color) return Val; else return -Val;
 }
@@ -4497,16 +6265,16 @@ short 	KPvKB(Game* Gm,Byte *flags)
  if(!(Gm->POSITION[1][1]&COR))											// bK not in corner
  {
   Val=KPvK(Gm,flags); 													// check position without bishop
-  if((Val==Paras[74].Val)&&(*flags==0)) return Val; 					// position draw even without bishop
+  if((Val==PAR(74))&&(*flags==0)) return Val;							// position draw even without bishop
  }											
- Val=2*Dist_s[bk][wps]-Dist_s[wk][wps]-Paras[103].Val;					// material value of bishop
- Val+=3*n*n+Paras[105].Val;												// value of pawn
- Val=Val<Paras[74].Val?Paras[74].Val:Val;								// white has at least a draw
+ Val=2*Dist_s[bk][wps]-Dist_s[wk][wps]-PAR(103);						// material value of bishop
+ Val+=3*n*n+PAR(105);													// value of pawn
+ Val=Val<PAR(74)?PAR(74):Val;											// white has at least a draw
  if(Gm->color) {*flags=1; Val=-Val;} else *flags=2;
  if(BM&(STEP[1][wk]|STEP[3][wps]))			*flags=64;					// bishop is attacked
  else if((PAWN_E[0][0][wps]&STEP[11][bbs])&&							// bishop controls pawn's spawn
   			(!(STEP[11][bbs]&Gm->POSITION[1][1]))) 						// and is not blocked by king
-  						{*flags=0; return Paras[74].Val;}				// exact draw
+  						{*flags=0; return PAR(74);}						// exact draw
  return Val;
 }
 
@@ -4524,16 +6292,16 @@ short 	KBvKP(Game* Gm,Byte *flags)
  if(!(Gm->POSITION[0][1]&COR))											// bK not in corner
  {
   Val=KvKP(Gm,flags); 													// check position without bishop
-  if((Val==Paras[74].Val)&&(*flags==0)) return Val; 					// position draw even without bishop
+  if((Val==PAR(74))&&(*flags==0)) return Val;							// position draw even without bishop
  }											
- Val=2*Dist_s[wk][bps]-Dist_s[bk][bps]-Paras[103].Val;					// material value of bishop
- Val+=3*n*n+Paras[105].Val;												// value of pawn
- Val=Val<Paras[74].Val?Paras[74].Val:Val;								// white has at least a draw
+ Val=2*Dist_s[wk][bps]-Dist_s[bk][bps]-PAR(103);						// material value of bishop
+ Val+=3*n*n+PAR(105);													// value of pawn
+ Val=Val<PAR(74)?PAR(74):Val;											// white has at least a draw
  if(Gm->color) *flags=2; else {*flags=1; Val=-Val;}
  if(BM&(STEP[1][bk]|STEP[4][bps]))			*flags=64;					// bishop is attacked
  else if((PAWN_E[1][0][bps]&STEP[11][wbs])&&							// bishop controls pawn's spawn
   			(!(STEP[11][wbs]&Gm->POSITION[0][1]))) 						// and is not blocked by king
-  						{*flags=0; return Paras[74].Val;}				// exact draw
+  						{*flags=0; return PAR(74);}						// exact draw
  return Val;
 }
 
@@ -4558,9 +6326,9 @@ short 	KPvKN(Game* Gm, Byte *flags)
   Val+=2*Dist[bk][wps]-Dist[wk][wps];
   if(!(BN&(STEP[1][wk]|STEP[3][wps])))									// knight not attacked
    if(PAWN_E[0][0][wps]&Gm->POSITION[1][1]) 							// king on pawn's spawn
-    							{*flags=0; return Paras[74].Val;}		// exact draw
+    							{*flags=0; return PAR(74);}				// exact draw
   Val+=5*Dist[wps][find_b[(BN^BN-1)%67]];								// distance of knight
-  Val=Val<Paras[74].Val?Paras[74].Val:Val;								// white has at least draw
+  Val=Val<PAR(74)?PAR(74):Val;											// white has at least draw
   if(Gm->color) *flags=1; else *flags=2;								// white has at least pos value maybe won
  }
  if(BN&(STEP[1][wk]|STEP[3][wps]))						*flags=64;		// knight attacked 
@@ -4589,9 +6357,9 @@ short 	KNvKP(Game* Gm, Byte *flags)
   Val+=2*Dist[wk][bps]-Dist[bk][bps];
   if(!(WN&(STEP[1][bk]|STEP[4][bps])))									// knight not attacked
    if(PAWN_E[1][0][bps]&Gm->POSITION[0][1]) 							// king on pawn's spawn
-    							{*flags=0; return Paras[74].Val;}		// exact draw
+    							{*flags=0; return PAR(74);}				// exact draw
   Val+=5*Dist[bps][find_b[(WN^WN-1)%67]];								// distance of knight
-  Val=Val<Paras[74].Val?Paras[74].Val:Val;								// black has at least draw
+  Val=Val<PAR(74)?PAR(74):Val;											// black has at least draw
   if(Gm->color) *flags=2; else *flags=1;								// black has at least pos value maybe won
  }
  if(WN&(STEP[1][bk]|STEP[4][bps]))						*flags=64;		// knight attacked 
@@ -4614,7 +6382,7 @@ short 	KQvKP(Game* Gm, Byte *flags)
 	{if(Gm->color) *flags=2; else *flags=1; Val=70-10*Dist[wk][n];}
  else
  {
-  Val=Paras[101].Val-Paras[105].Val-20*Dist[wk][n];						// progress of wk
+  Val=PAR(101)-PAR(105)-20*Dist[wk][n];									// progress of wk
   Val-=4*(n>>3)*(n>>3); *flags=64;										// progress of black pawn	
  }
  if(Gm->color) return -Val; else return Val;
@@ -4632,10 +6400,10 @@ short	KPvKQ(Game* Gm, Byte *flags)
  if(Dist[bk][n]<4)  								return 0;			// bK too close to pawn or pawn not defended by wK
  if(((n==8)&&(KM&PWKA))||((n==15)&&(KM&PWKH))||				
     ((n==10)&&(KM&PWKC))||((n==13)&&(KM&PWKF))) 						// PWKC PWKF
-	 {*flags=0; Val=Paras[74].Val;}
+	 {*flags=0; Val=PAR(74);}
  else
  {
-  Val=Paras[101].Val-Paras[105].Val-20*Dist[bk][n];						// progress of bK
+  Val=PAR(101)-PAR(105)-20*Dist[bk][n];									// progress of bK
   n=7-(n>>3); Val-=4*n*n; *flags=64;									// progress of wP
  }
  if(Gm->color) return Val; else return -Val;										
@@ -4665,7 +6433,7 @@ short 	KPvKP(Game* Gm,Byte *flags)										// checked
  *flags=0;																// exact value
  if((A8<<wk)&KPVKP[((wp>>3)-2)*4+(wp&3)][Gm->color*64+bk])				// position is won for stm
  { 
-  V+=Paras[101].Val-2*Paras[105].Val;									// value is queen-pawn-promotion bonus
+  V+=PAR(101)-2*PAR(105);												// value is queen-pawn-promotion bonus
   if(Gm->color) return -V; else return V;								// evaluation depends on stm
  }
  wp=8*(7-(bp>>3))+(bp&7); mwk=wk;                      					// swap pawns and mirror vertically
@@ -4673,10 +6441,10 @@ short 	KPvKP(Game* Gm,Byte *flags)										// checked
  
  if((A8<<wk)&KPVKP[((wp>>3)-2)*4+(wp&3)][(1-Gm->color)*64+bk])			// position is won for opponent
  { 
-  V-=Paras[101].Val-2*Paras[105].Val;									// value is queen-pawn-promotion bonus
+  V-=PAR(101)-2*PAR(105);												// value is queen-pawn-promotion bonus
   if(Gm->color) return -V; else return V;								// evaluation depends on stm
  }
- return Paras[74].Val;													// position is draw        
+ return PAR(74);														// position is draw        
 }
 
 short 	KRBvKR(Game* Gm, Byte *flags)
@@ -4690,7 +6458,7 @@ short 	KRBvKR(Game* Gm, Byte *flags)
  if((Gm->Count[0]).officers+(Gm->Count[1]).officers>5) 
  												{*flags=128; return 0;}	// more than two rooks and one bishop
  Val=0+10*Dist_c[bk]-5*Dist[wk][bk];
- Val=Val<Paras[74].Val?Paras[74].Val:Val;								// white has at least a draw
+ Val=Val<PAR(74)?PAR(74):Val;											// white has at least a draw
  if(Gm->color) {*flags=1; Val=-Val;} else 		*flags=2;				// white has at least pos value	
  if(BR&(STEP[1][wk]|STEP[11][wbs]))				*flags=64;				// black rook attacked
  if((WR|WB)&(STEP[1][bk]|STEP[10][brs]))		*flags=64;				// white rook or bishop attacked
@@ -4708,7 +6476,7 @@ short 	KRvKRB(Game* Gm, Byte *flags)
  if((Gm->Count[0]).officers+(Gm->Count[1]).officers>5) 
  												{*flags=128; return 0;}	// more than two rooks and one bishop
  Val=0+10*Dist_c[wk]-5*Dist[wk][bk];
- Val=Val<Paras[74].Val?Paras[74].Val:Val;								// black has at least a draw
+ Val=Val<PAR(74)?PAR(74):Val;											// black has at least a draw
  if(Gm->color) *flags=2;  else 					{*flags=1; Val=-Val;}	// black has at least pos value	
  if(WR&(STEP[1][bk]|STEP[11][bbs]))				*flags=64;				// white rook attacked
  if((BR|BB)&(STEP[1][wk]|STEP[10][wrs]))		*flags=64;				// black rook or bishop attacked
@@ -4727,7 +6495,7 @@ short 	KRNvKR(Game* Gm, Byte *flags)
  if((Gm->Count[0]).officers+(Gm->Count[1]).officers>5) 
  												{*flags=128; return 0;}	// more than two rooks and one bishop
  Val=0+10*Dist_c[bk]-5*Dist[wk][bk];
- Val=Val<Paras[74].Val?Paras[74].Val:Val;								// white has at least a draw
+ Val=Val<PAR(74)?PAR(74):Val;											// white has at least a draw
  if(Gm->color) {*flags=1; Val=-Val;} else *flags=2;						// white has at least pos value	
  if(BR&(STEP[1][wk]|STEP[2][wns]))				*flags=64;				// black rook attacked
  if((WR|WN)&(STEP[1][bk]|STEP[10][brs]))		*flags=64;				// white rook or knight attacked
@@ -4746,7 +6514,7 @@ short 	KRvKRN(Game* Gm, Byte *flags)
  if((Gm->Count[0]).officers+(Gm->Count[1]).officers>5) 
  												{*flags=128; return 0;}	// more than two rooks and one bishop
  Val=0+10*Dist_c[wk]-5*Dist[wk][bk];
- Val=Val<Paras[74].Val?Paras[74].Val:Val;								// black has at least a draw
+ Val=Val<PAR(74)?PAR(74):Val;											// black has at least a draw
  if(Gm->color) *flags=2; 				else {*flags=1; Val=-Val;}		// black has at least pos value	
  if(WR&(STEP[1][bk]|STEP[2][bns]))				*flags=64;				// white rook attacked
  if((BR|BN)&(STEP[1][wk]|STEP[10][wrs]))		*flags=64;				// black rook or knight attacked
@@ -4757,14 +6525,14 @@ short 	KBvKB(Game* Gm, Byte *flags)
 {
  *flags=128; 															// default is back off
  if((Gm->Count[0]).officers+(Gm->Count[1]).officers>4)		return 0;	// one side has more than one bishop
- *flags=0; return Paras[74].Val;										// position is draw
+ *flags=0; return PAR(74);												// position is draw
 }
 
 short 	KNvKN(Game* Gm, Byte *flags)
 {
  *flags=128; 															// default is back off
  if((Gm->Count[0]).officers+(Gm->Count[1]).officers>4)		return 0;	// one side has more than one 
- *flags=0; return Paras[74].Val;										// position is draw
+ *flags=0; return PAR(74);												// position is draw
 }
 
 short	KQvKR(Game* Gm, Byte *flags)
@@ -4779,7 +6547,7 @@ short	KQvKR(Game* Gm, Byte *flags)
  if((WQ&(STEP[1][bk]|STEP[10][brs]))||(BR&(STEP[1][wk]|STEP[11][wqs]))||// or rook queen attacked
 	(BOR&(Gm->POSITION[0][1]|Gm->POSITION[1][1]))) *flags=64;			// king at border
 	
- Val=Paras[101].Val-Paras[102].Val;										// material value
+ Val=PAR(101)-PAR(102);													// material value
  Val+=2*Dist_s[bk][brs]-Dist_s[bk][wk]+15*Dist_c[bk];					// distance of rook to king, king to king...
  																		// and king to center
  return Val; 
@@ -4797,7 +6565,7 @@ short	KRvKQ(Game* Gm, Byte *flags)
  if((BQ&(STEP[1][wk]|STEP[10][wrs]))||(WR&(STEP[1][bk]|STEP[11][bqs]))||// or rook queen attacked
 	(BOR&(Gm->POSITION[0][1]|Gm->POSITION[1][1]))) *flags=64;			// king at border
 	
- Val=Paras[101].Val-Paras[102].Val;										// material value
+ Val=PAR(101)-PAR(102);													// material value
  Val+=2*Dist_s[wk][wrs]-Dist_s[bk][wk]+15*Dist_c[wk];					// distance of rook to king, king to king...
  																		// and king to center
  return -Val; 
@@ -4814,7 +6582,7 @@ short 	KRvKR(Game* Gm, Byte *flags)
  											{*flags=128; return 0;}		// more than one piece per side
  if((WR&(STEP[1][bk]|STEP[10][brs]))||(BR&(STEP[1][wk]))||				// rook attacked
 	(BOR&(Gm->POSITION[0][1]|Gm->POSITION[1][1]))) *flags=64;			// king at border
- return Paras[74].Val; 
+ return PAR(74); 
 }
 
 short 	KQvKQ(Game* Gm, Byte *flags)
@@ -4829,7 +6597,7 @@ short 	KQvKQ(Game* Gm, Byte *flags)
  if((WQ&(STEP[1][bk]|STEP[10][bqs]|STEP[11][bqs]))||					// white queen attacked
     (BQ&(STEP[1][wk]))||												// black queen attacked
 	(BOR&(Gm->POSITION[0][1]|Gm->POSITION[1][1]))) *flags=64;			// king at border
- return Paras[74].Val;   												// position is draw
+ return PAR(74);														// position is draw
 }
 
 short 	KBPvKB(Game* Gm, Byte *flags)
@@ -4852,16 +6620,16 @@ short 	KBPvKB(Game* Gm, Byte *flags)
  if(WP&(P6|P7))										*flags=64;  		// pawn too far advanced	
  if(STEP[11][bbs]&PS) 													// bishop attacks pawn's spawn
  {
-  if(!((BB&WB&BS)||(BB&WB&WS)))					return Paras[74].Val;	// bishops on different colours
+  if(!((BB&WB&BS)||(BB&WB&WS)))					return PAR(74);			// bishops on different colours
   Val-=15;																// malus for bishop controls spawn 			
  }
  if(Gm->POSITION[1][1]&PS)												// king is on pawn's spawn
  {
-  if(Gm->POSITION[1][1]&WS) {if(WB&BS) 			return Paras[74].Val;}	// king on spawn and not on bishop color
-  else if(WB&WS) 								return Paras[74].Val;
+  if(Gm->POSITION[1][1]&WS) {if(WB&BS) 			return PAR(74);}		// king on spawn and not on bishop color
+  else if(WB&WS) 								return PAR(74);
   Val-=20;																// add malus for king on spawn
  }
- Val=Val<Paras[74].Val?Paras[74].Val:Val;								// white has at least a draw
+ Val=Val<PAR(74)?PAR(74):Val;											// white has at least a draw
  if(Gm->color) Val=-Val;
  if(*flags==64) 								return Val;				// unclear position
  if(Gm->color) *flags=1; else *flags=2;									// white has at least pos value	
@@ -4888,16 +6656,16 @@ short 	KBvKBP(Game* Gm, Byte *flags)
  if(BP&(P2|P3))										*flags=64;  		// pawn too far advanced	
  if(STEP[11][wbs]&PS) 													// bishop attacks pawn's spawn
  {
-  if(!((BB&WB&BS)||(BB&WB&WS)))					return Paras[74].Val;	// bishops on different colours
+  if(!((BB&WB&BS)||(BB&WB&WS)))					return PAR(74);			// bishops on different colours
   Val-=15;																// malus for bishop controls spawn 			
  }
  if(Gm->POSITION[0][1]&PS)												// king is on pawn's spawn
  {
-  if(Gm->POSITION[0][1]&WS) {if(BB&BS) 			return Paras[74].Val;}	// king on spawn and not on bishop color
-  else if(BB&WS) 								return Paras[74].Val;
+  if(Gm->POSITION[0][1]&WS) {if(BB&BS) 			return PAR(74);}		// king on spawn and not on bishop color
+  else if(BB&WS) 								return PAR(74);
   Val-=20;																// add malus for king on spawn
  }
- Val=Val<Paras[74].Val?Paras[74].Val:Val;								// white has at least a draw
+ Val=Val<PAR(74)?PAR(74):Val;											// white has at least a draw
  if(!Gm->color) Val=-Val;
  if(*flags==64) 								return Val;				// unclear position
  if(Gm->color) *flags=2; else *flags=1;									// white has at least pos value	
@@ -4919,7 +6687,7 @@ short 	KNPvKB(Game* Gm, Byte *flags)
  Val=2*Square[0][5][1][wps]+20*Dist[bk][pr]-5*Dist[wk][pr];				// pawn's progress and distance of kings
  if(Gm->POSITION[1][1]&PS) 	Val-=30;									// black king is on pawn's spawn
  if(STEP[11][bbs]&PS)		Val-=40; 									// black bishop attacks black pawn's spawn
- Val=Val<Paras[74].Val?Paras[74].Val:Val;
+ Val=Val<PAR(74)?PAR(74):Val;
  if(Gm->color) {*flags=1; Val=-Val;} else *flags=2;						// white has at least pos value	
  if(WP&(P6|P7))								 	 		*flags=64;		// pawn too far advanced
  if(BB&(STEP[1][wk]|STEP[2][wns]|STEP[3][wps])) 		*flags=64;		// bishop attacked
@@ -4942,7 +6710,7 @@ short 	KBvKNP(Game* Gm, Byte *flags)
  Val=2*Square[1][5][1][bps]+20*Dist[wk][pr]-5*Dist[bk][pr];				// pawn's progress and distance of kings
  if(Gm->POSITION[0][1]&PS) 	Val-=30;									// black king is on pawn's spawn
  if(STEP[11][wbs]&PS)		Val-=40; 									// black bishop attacks black pawn's spawn
- Val=Val<Paras[74].Val?Paras[74].Val:Val;
+ Val=Val<PAR(74)?PAR(74):Val;
  if(Gm->color) *flags=2; else {*flags=1; Val=-Val;}						// white has at least pos value	
  if(BP&(P2|P3))								 	 		*flags=64;		// pawn too far advanced
  if(WB&(STEP[1][bk]|STEP[2][bns]|STEP[4][bps])) 		*flags=64;		// bishop attacked
@@ -4963,7 +6731,7 @@ short 	KRvKB(Game* Gm, Byte *flags)
  else Val=70-10*Dist_b[1][bk];	
  	
  Val-=5*Dist[wk][bk];													// distance between kings
- Val=Val<Paras[74].Val?Paras[74].Val:Val;								// white has at least a draw
+ Val=Val<PAR(74)?PAR(74):Val;											// white has at least a draw
  if(Gm->color) {*flags=1; Val=-Val;} else 	*flags=2;					// black has at most pos val, maybe lost
  if(BB&(STEP[1][wk]|STEP[10][wrs])) 		*flags=64;					// bishop is attacked
  if(WR&(STEP[1][bk]|STEP[11][bbs])) 		*flags=64;					// rook is attacked
@@ -4982,7 +6750,7 @@ short 	KBvKR(Game* Gm, Byte *flags)
  if(WB&WS) Val=70-10*Dist_b[0][wk]; 									// distance of wK to bishop's color corner
  else Val=70-10*Dist_b[1][wk];	
  Val-=5*Dist[wk][bk];													// distance between kings
- Val=Val<Paras[74].Val?Paras[74].Val:Val;								// black has at least a draw
+ Val=Val<PAR(74)?PAR(74):Val;											// black has at least a draw
  if(Gm->color) *flags=2; else {*flags=1; Val=-Val;}						// white has at most pos val, maybe lost
  if(WB&(STEP[1][bk]|STEP[10][brs])) 		*flags=64;					// bishop is attacked
  if(BR&(STEP[1][wk]|STEP[11][wbs])) 		*flags=64;					// rook is attacked
@@ -5008,7 +6776,7 @@ short 	KRvKN(Game* Gm, Byte *flags)
   Val+=5*Dist[bns][bk]+10*Dist_c[bns]-50; 								// distance of knight to king and center
   if(WR&STEP[2][bns])							*flags=64;  			// rook is attacked
  }									
- Val=Val<Paras[74].Val?Paras[74].Val:Val;								// white has at least a draw
+ Val=Val<PAR(74)?PAR(74):Val;											// white has at least a draw
  
  if(Gm->color) return -Val; else return Val;
 }
@@ -5032,7 +6800,7 @@ short 	KNvKR(Game* Gm, Byte *flags)
   Val+=5*Dist[wns][wk]+10*Dist_c[wns]-50; 								// distance of knight to king and center
   if(BR&STEP[2][wns])							*flags=64;  			// rook is attacked
  }									
- Val=Val<Paras[74].Val?Paras[74].Val:Val;								// black has at least a draw
+ Val=Val<PAR(74)?PAR(74):Val;											// black has at least a draw
  
  if(Gm->color) return Val; else return -Val;
 }
@@ -5042,7 +6810,7 @@ short 	KBvKN(Game* Gm, Byte *flags)
  if((Gm->Count[0]).officers+(Gm->Count[1]).officers>4)	*flags=128;		// one side has more than one piece
  else if((Gm->POSITION[0][1]|Gm->POSITION[1][1])&COR)	*flags=64;		// king in corner
  else													*flags=0; 		// exact score
- return Paras[74].Val-1;												// position is draw	
+ return PAR(74)-1;														// position is draw	
 }
 
 short 	KNvKB(Game* Gm, Byte *flags)
@@ -5050,7 +6818,7 @@ short 	KNvKB(Game* Gm, Byte *flags)
  if((Gm->Count[0]).officers+(Gm->Count[1]).officers>4)	*flags=128;		// one side has more than one piece
  else if((Gm->POSITION[0][1]|Gm->POSITION[1][1])&COR)	*flags=64;		// king in corner
  else													*flags=0; 		// exact score
- return Paras[74].Val-1;												// position is draw	
+ return PAR(74)-1;														// position is draw	
 }
 
 short 	KRvKP(Game* Gm, Byte *flags)
@@ -5073,7 +6841,7 @@ short 	KRPvKR(Game* Gm, Byte *flags)
  
  if(((Gm->Count[0]).officers+(Gm->Count[1]).officers>4)||				// more than two rooks or pawns in game
   ((Gm->Count[0]).pawns>2))				{*flags=128; return 0;}			// back off
- *flags=64;	Val=(Gm->Count[0]).pawns*Paras[105].Val; PS=WP; lk=bk&7;	// default is unclear, material value
+ *flags=64;	Val=(Gm->Count[0]).pawns*PAR(105); PS=WP; lk=bk&7;			// default is unclear, material value
  while(PS)																// parse white pawns
  {
   sp=find_b[(PS^PS-1)%67]; PS&=PS-1; r=7-(sp>>3); lp=sp&7;				// rank of pawn
@@ -5105,7 +6873,7 @@ short 	KRvKRP(Game* Gm, Byte *flags)
  
  if(((Gm->Count[0]).officers+(Gm->Count[1]).officers>4)||				// more than two rooks or pawns in game
   ((Gm->Count[1]).pawns>2))				{*flags=128; return 0;}			// back off
- *flags=64;	Val=(Gm->Count[1]).pawns*Paras[105].Val; PS=BP; lk=wk&7;	// default is unclear, material value
+ *flags=64;	Val=(Gm->Count[1]).pawns*PAR(105); PS=BP; lk=wk&7;			// default is unclear, material value
  while(PS)																// parse white pawns
  {
   sp=find_b[(PS^PS-1)%67]; PS&=PS-1; r=sp>>3; lp=sp&7;					// rank of pawn